@@ -0,0 +1,154 @@
+#include "allocstats.h"
+#include <QVector>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef QUICKNOTE_ALLOC_STATS
+
+namespace {
+// Triviale thread_local-Werte brauchen selbst keine Anforderung
+thread_local quint64 t_allocations = 0;
+thread_local quint64 t_bytes = 0;
+
+inline void count(std::size_t size)
+{
+    ++t_allocations;
+    t_bytes += size;
+}
+} // namespace
+
+#if defined(__GLIBC__)
+// Alle Anforderungen laufen über malloc, auch operator new und die Qt-Container
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(std::size_t size) noexcept
+{
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count_, std::size_t size) noexcept
+{
+    count(count_ * size);
+    return __libc_calloc(count_, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept
+{
+    if (size > 0) count(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept
+{
+    __libc_free(ptr);
+}
+}
+#else
+void* operator new(std::size_t size)
+{
+    count(size);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    count(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+#endif // QUICKNOTE_ALLOC_STATS
+
+namespace AllocStats {
+
+namespace {
+const int MAX_RECORDS = 10000;      // Ältere Aufrufe werden verworfen
+QVector<Counters> s_keystrokes;
+quint64 s_keystrokeCount = 0;
+
+QJsonObject percentiles(QVector<quint64> values)
+{
+    QJsonObject result;
+    if (values.isEmpty()) return result;
+    std::sort(values.begin(), values.end());
+    const auto at = [&values](double p) {
+        return double(values[qMin(int(values.size()) - 1, int(p * values.size()))]);
+    };
+    result["p50"] = at(0.50);
+    result["p90"] = at(0.90);
+    result["p99"] = at(0.99);
+    result["max"] = double(values.last());
+    return result;
+}
+} // namespace
+
+bool enabled()
+{
+#ifdef QUICKNOTE_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+Counters current()
+{
+    Counters counters;
+#ifdef QUICKNOTE_ALLOC_STATS
+    counters.allocations = t_allocations;
+    counters.bytes = t_bytes;
+#endif
+    return counters;
+}
+
+void recordKeystroke(const Counters& counters)
+{
+    if (!enabled()) return;
+    if (s_keystrokes.size() >= MAX_RECORDS) {
+        s_keystrokes.remove(0, MAX_RECORDS / 2);
+    }
+    s_keystrokes.append(counters);
+    ++s_keystrokeCount;
+}
+
+QJsonObject keystrokeSummary()
+{
+    QJsonObject summary;
+    summary["enabled"] = enabled();
+    summary["keystrokes"] = double(s_keystrokeCount);
+    QVector<quint64> allocations;
+    QVector<quint64> bytes;
+    allocations.reserve(s_keystrokes.size());
+    bytes.reserve(s_keystrokes.size());
+    for (const Counters& counters : s_keystrokes) {
+        allocations.append(counters.allocations);
+        bytes.append(counters.bytes);
+    }
+    summary["allocations"] = percentiles(allocations);
+    summary["bytes"] = percentiles(bytes);
+    return summary;
+}
+
+} // namespace AllocStats
@@ -0,0 +1,64 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <QtGlobal>
+#include <QJsonObject>
+
+/**
+ * @brief Zählt Speicheranforderungen je Thread (Build-Option QUICKNOTE_ALLOC_STATS)
+ *
+ * Mit der Option ersetzt allocstats.cpp unter glibc malloc, calloc, realloc
+ * und free und erfasst damit auch Puffer von QString, QByteArray und zlib.
+ * Auf anderen Systemen wird nur der globale operator new ersetzt. Gezählt
+ * wird immer für den aufrufenden Thread, Arbeit im Thread-Pool taucht in
+ * den Zahlen des GUI-Threads nicht auf. Ohne die Option ist enabled() false
+ * und alle Zähler bleiben 0.
+ */
+namespace AllocStats {
+
+struct Counters {
+    quint64 allocations = 0;
+    quint64 bytes = 0;
+};
+
+bool enabled();
+
+/**
+ * @brief Summe aller Anforderungen des aufrufenden Threads seit dem Start
+ */
+Counters current();
+
+/**
+ * @brief Misst die Anforderungen des aufrufenden Threads ab der Konstruktion
+ */
+class Scope
+{
+public:
+    Scope() : m_start(current()) {}
+
+    Counters elapsed() const
+    {
+        const Counters now = current();
+        Counters result;
+        result.allocations = now.allocations - m_start.allocations;
+        result.bytes = now.bytes - m_start.bytes;
+        return result;
+    }
+
+private:
+    Counters m_start;
+};
+
+/**
+ * @brief Hält das Ergebnis eines onTextChanged-Aufrufs fest, nur im GUI-Thread
+ */
+void recordKeystroke(const Counters& counters);
+
+/**
+ * @brief Anzahl, Perzentile und Maximum der letzten festgehaltenen Aufrufe
+ */
+QJsonObject keystrokeSummary();
+
+} // namespace AllocStats
+
+#endif
@@ -0,0 +1,61 @@
+#include "clipboardtext.h"
+#include <QStringList>
+#include <QVariant>
+
+namespace {
+
+const char PLAIN_TEXT[] = "text/plain";
+
+} // namespace
+
+ClipboardText::ClipboardText(const QJsonObject& entry, qsizetype start, qsizetype length)
+    : m_entry(entry), m_start(start), m_length(length), m_rendered(false)
+{
+}
+
+ClipboardText::ClipboardText(const QString& text)
+    : m_text(text), m_start(0), m_length(-1), m_rendered(false)
+{
+}
+
+QStringList ClipboardText::formats() const
+{
+    return {QString::fromLatin1(PLAIN_TEXT)};
+}
+
+bool ClipboardText::hasFormat(const QString& mimeType) const
+{
+    return mimeType == QLatin1String(PLAIN_TEXT);
+}
+
+QVariant ClipboardText::retrieveData(const QString& mimeType, QMetaType type) const
+{
+    Q_UNUSED(type);
+    if (mimeType != QLatin1String(PLAIN_TEXT)) return QVariant();
+    render();
+    return m_text;
+}
+
+/**
+ * @brief Bildet den Text beim ersten Abruf, Trennzeichen werden in einem Durchlauf ersetzt
+ */
+void ClipboardText::render() const
+{
+    if (m_rendered) return;
+    if (!m_entry.isEmpty()) {
+        m_text = m_entry["text"].toString().mid(m_start, m_length);
+        m_entry = QJsonObject();
+    }
+
+    QChar* data = m_text.data();
+    const qsizetype size = m_text.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        const QChar c = data[i];
+        if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator) {
+            data[i] = QLatin1Char('\n');
+        } else if (c == QChar::Nbsp) {
+            data[i] = QLatin1Char(' ');
+        }
+    }
+    m_rendered = true;
+}
@@ -0,0 +1,52 @@
+#ifndef CLIPBOARDTEXT_H
+#define CLIPBOARDTEXT_H
+
+#include <QMimeData>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief Text für die Zwischenablage, der erst bei Bedarf erzeugt wird
+ *
+ * Beim Kopieren wird nur eine geteilte Referenz gemerkt: entweder der
+ * History-Eintrag, dessen Text gerade angezeigt wird, samt Auswahlbereich,
+ * oder der bereits ausgewählte Text. Erst wenn ein Programm die Daten
+ * anfordert, wird der Ausschnitt gebildet und Absatz- und Zeilentrenner
+ * sowie geschützte Leerzeichen in einem Durchlauf an Ort und Stelle
+ * ersetzt. Das Ergebnis wird für weitere Anfragen behalten, die Quelle
+ * danach freigegeben.
+ */
+class ClipboardText : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Ausschnitt aus dem Text eines History-Eintrags
+     *
+     * Positionen im Dokument entsprechen im reinen Text denselben Indizes.
+     */
+    ClipboardText(const QJsonObject& entry, qsizetype start, qsizetype length);
+
+    /**
+     * @brief Bereits ausgewählter Text, z.B. aus QTextCursor::selectedText()
+     */
+    explicit ClipboardText(const QString& text);
+
+    QStringList formats() const override;
+    bool hasFormat(const QString& mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString& mimeType, QMetaType type) const override;
+
+private:
+    mutable QJsonObject m_entry;
+    mutable QString m_text;
+    qsizetype m_start;
+    qsizetype m_length;
+    mutable bool m_rendered;
+
+    void render() const;
+};
+
+#endif
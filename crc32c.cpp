@@ -0,0 +1,142 @@
+#include "crc32c.h"
+#include <QtEndian>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+namespace {
+
+const quint32 POLYNOMIAL = 0x82f63b78;  // Castagnoli, bitweise umgekehrt
+
+/**
+ * @brief Tabellen für slicing-by-8, Tabelle k verarbeitet das Byte k Stellen vor dem Ende
+ */
+struct Tables {
+    quint32 t[8][256];
+
+    Tables()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (POLYNOMIAL & (0u - (crc & 1)));
+            }
+            t[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+quint32 computeSoftware(const unsigned char* p, qsizetype length, quint32 crc)
+{
+    static const Tables tables;
+    const auto& t = tables.t;
+    while (length >= 8) {
+        quint32 low, high;
+        std::memcpy(&low, p, 4);
+        std::memcpy(&high, p + 4, 4);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        low = qFromLittleEndian(low);
+        high = qFromLittleEndian(high);
+#endif
+        low ^= crc;
+        crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24]
+            ^ t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    }
+    return crc;
+}
+
+#if defined(CRC32C_X86)
+__attribute__((target("sse4.2")))
+quint32 computeHardware(const unsigned char* p, qsizetype length, quint32 crc)
+{
+#if defined(__x86_64__)
+    quint64 crc64 = crc;
+    while (length >= 8) {
+        quint64 value;
+        std::memcpy(&value, p, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+        p += 8;
+        length -= 8;
+    }
+    crc = quint32(crc64);
+#endif
+    while (length >= 4) {
+        quint32 value;
+        std::memcpy(&value, p, 4);
+        crc = _mm_crc32_u32(crc, value);
+        p += 4;
+        length -= 4;
+    }
+    while (length-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardware()
+{
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(CRC32C_ARM)
+quint32 computeHardware(const unsigned char* p, qsizetype length, quint32 crc)
+{
+    while (length >= 8) {
+        quint64 value;
+        std::memcpy(&value, p, 8);
+        crc = __crc32cd(crc, value);
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardware()
+{
+    return true;  // Zur Übersetzungszeit vorausgesetzt
+}
+#endif
+
+} // namespace
+
+namespace Crc32c {
+
+bool isHardwareAccelerated()
+{
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    static const bool available = detectHardware();
+    return available;
+#else
+    return false;
+#endif
+}
+
+quint32 compute(const char* data, qsizetype length, quint32 crc)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (isHardwareAccelerated()) return ~computeHardware(p, length, crc);
+#endif
+    return ~computeSoftware(p, length, crc);
+}
+
+} // namespace Crc32c
@@ -0,0 +1,27 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <QtGlobal>
+
+/**
+ * @brief CRC32C (Castagnoli) für die Prüfsummen der History-Blöcke
+ *
+ * Nutzt die CRC-Befehle von SSE4.2 bzw. ARMv8, wenn der Prozessor sie
+ * unterstützt, sonst eine Tabellenversion mit 8 Bytes pro Schritt.
+ */
+namespace Crc32c {
+
+/**
+ * @brief Berechnet die Prüfsumme oder setzt eine bestehende fort
+ * @param crc Ergebnis eines vorherigen Aufrufs für den davorliegenden Teil, sonst 0
+ */
+quint32 compute(const char* data, qsizetype length, quint32 crc = 0);
+
+/**
+ * @brief true wenn die Prüfsumme mit Prozessorbefehlen berechnet wird
+ */
+bool isHardwareAccelerated();
+
+} // namespace Crc32c
+
+#endif
@@ -0,0 +1,60 @@
+#include "debouncedwriter.h"
+#include <QTimer>
+#include <QThreadPool>
+#include <QMutexLocker>
+
+DebouncedWriter::DebouncedWriter(int delayMs, QObject *parent)
+    : QObject(parent), m_state(std::make_shared<State>()), m_timer(new QTimer(this)), m_sequence(0)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(delayMs);
+    connect(m_timer, &QTimer::timeout, this, &DebouncedWriter::writeLater);
+}
+
+DebouncedWriter::~DebouncedWriter()
+{
+    flush();
+    QMutexLocker locker(&m_state->mutex);  // Auf einen laufenden Schreibvorgang warten
+}
+
+void DebouncedWriter::schedule(std::function<void()> write)
+{
+    m_pending = std::move(write);
+    // Nicht bei jedem Tastendruck neu starten, sonst wird beim Dauertippen nie geschrieben
+    if (!m_timer->isActive()) m_timer->start();
+}
+
+void DebouncedWriter::cancel()
+{
+    m_timer->stop();
+    m_pending = nullptr;
+}
+
+void DebouncedWriter::writeLater()
+{
+    if (!m_pending) return;
+    const std::shared_ptr<State> state = m_state;
+    const std::function<void()> write = std::move(m_pending);
+    const quint64 sequence = ++m_sequence;
+    m_pending = nullptr;
+    QThreadPool::globalInstance()->start([state, write, sequence]() {
+        run(*state, write, sequence);
+    });
+}
+
+void DebouncedWriter::flush()
+{
+    m_timer->stop();
+    if (!m_pending) return;
+    const std::function<void()> write = std::move(m_pending);
+    m_pending = nullptr;
+    run(*m_state, write, ++m_sequence);
+}
+
+void DebouncedWriter::run(State& state, const std::function<void()>& write, quint64 sequence)
+{
+    QMutexLocker locker(&state.mutex);
+    if (sequence <= state.sequence) return;     // Ein neuerer Auftrag war schneller
+    state.sequence = sequence;
+    write();
+}
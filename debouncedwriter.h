@@ -0,0 +1,63 @@
+#ifndef DEBOUNCEDWRITER_H
+#define DEBOUNCEDWRITER_H
+
+#include <QObject>
+#include <QMutex>
+#include <functional>
+#include <memory>
+
+class QTimer;
+
+/**
+ * @brief Führt den zuletzt vorgemerkten Schreibvorgang verzögert im Thread-Pool aus
+ *
+ * schedule() merkt sich nur den Auftrag und startet den Timer, ohne ihn
+ * neu zu starten; so wird auch beim Dauertippen höchstens alle delayMs
+ * geschrieben. Aufträge laufen nacheinander, ein älterer wird übersprungen,
+ * wenn ein neuerer schon geschrieben hat. Der Auftrag hält seine Daten
+ * selbst, etwa implizit geteilte Strings, und wandelt sie erst im
+ * Thread-Pool um.
+ */
+class DebouncedWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    DebouncedWriter(int delayMs, QObject *parent = nullptr);
+
+    /**
+     * @brief Schreibt einen ausstehenden Auftrag und wartet auf laufende
+     */
+    ~DebouncedWriter();
+
+    /**
+     * @brief Ersetzt den ausstehenden Auftrag
+     */
+    void schedule(std::function<void()> write);
+
+    /**
+     * @brief Verwirft den ausstehenden Auftrag
+     */
+    void cancel();
+
+    /**
+     * @brief Führt einen ausstehenden Auftrag sofort im aufrufenden Thread aus
+     */
+    void flush();
+
+private:
+    struct State {
+        QMutex mutex;               // Schreibvorgänge laufen nacheinander
+        quint64 sequence = 0;       // Nummer des zuletzt ausgeführten Auftrags
+    };
+
+    std::shared_ptr<State> m_state;
+    QTimer* m_timer;
+    std::function<void()> m_pending;
+    quint64 m_sequence;
+
+    void writeLater();
+    static void run(State& state, const std::function<void()>& write, quint64 sequence);
+};
+
+#endif
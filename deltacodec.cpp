@@ -0,0 +1,109 @@
+#include "deltacodec.h"
+#include <zlib.h>
+
+namespace {
+
+const qint64 MAX_TEXT_BYTES = qint64(1) << 30;
+
+/**
+ * @brief Teil des Vorgängers, der vor dem Abschnitt ab offset als Wörterbuch dient
+ *
+ * Reicht je zur Hälfte des freien Platzes vor und hinter den Abschnitt,
+ * damit eine Verschiebung um bis zu 8 KB noch gefunden wird.
+ */
+void dictionaryFor(const QByteArray& previous, qint64 offset, qint64* start, qint64* length)
+{
+    const qint64 slack = (DeltaCodec::WINDOW_BYTES - DeltaCodec::SEGMENT_BYTES) / 2;
+    const qint64 end = qMin<qint64>(previous.size(), offset + DeltaCodec::SEGMENT_BYTES + slack);
+    *start = qMax<qint64>(0, end - DeltaCodec::WINDOW_BYTES);
+    *length = end - *start;
+}
+
+} // namespace
+
+namespace DeltaCodec {
+
+QByteArray encode(const QByteArray& previous, const QByteArray& text)
+{
+    if (text.isEmpty() || text.size() > MAX_TEXT_BYTES) return QByteArray();
+
+    // Roher Strom: deflateSetDictionary ist dann auch nach jedem abgeschlossenen Block erlaubt
+    z_stream zs = {};
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return QByteArray();
+    }
+
+    QByteArray out;
+    qint64 used = 0;
+    bool ok = true;
+    for (qint64 offset = 0; ok && offset < text.size(); offset += SEGMENT_BYTES) {
+        const qint64 length = qMin<qint64>(SEGMENT_BYTES, text.size() - offset);
+        const bool last = offset + length >= text.size();
+        qint64 dictionaryStart = 0, dictionaryLength = 0;
+        dictionaryFor(previous, offset, &dictionaryStart, &dictionaryLength);
+        if (dictionaryLength > 0) {
+            ok = deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(previous.constData() + dictionaryStart),
+                                      uInt(dictionaryLength)) == Z_OK;
+        }
+
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.constData() + offset));
+        zs.avail_in = uInt(length);
+        // Z_BLOCK schließt den Abschnitt ab, ohne auf Bytegrenzen aufzufüllen
+        while (ok) {
+            const qint64 needed = qint64(deflateBound(&zs, zs.avail_in)) + 64;
+            if (out.size() - used < needed) out.resize(used + needed);
+            zs.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+            zs.avail_out = uInt(out.size() - used);
+            const int result = deflate(&zs, last ? Z_FINISH : Z_BLOCK);
+            used = out.size() - zs.avail_out;
+            if (result == Z_STREAM_END) break;
+            if (result != Z_OK && result != Z_BUF_ERROR) ok = false;
+            if (!last && zs.avail_in == 0 && zs.avail_out > 0) break;
+        }
+    }
+    deflateEnd(&zs);
+
+    if (!ok) return QByteArray();
+    out.resize(used);
+    return out;
+}
+
+bool decode(const QByteArray& previous, const QByteArray& delta, qint64 size, QByteArray* text)
+{
+    if (size <= 0 || size > MAX_TEXT_BYTES) return false;
+
+    z_stream zs = {};
+    if (inflateInit2(&zs, -15) != Z_OK) return false;
+    text->resize(size);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(delta.constData()));
+    zs.avail_in = uInt(delta.size());
+
+    // Wörterbücher an denselben Stellen setzen wie beim Kodieren
+    bool ok = true;
+    for (qint64 offset = 0; ok && offset < size; offset += SEGMENT_BYTES) {
+        const qint64 length = qMin<qint64>(SEGMENT_BYTES, size - offset);
+        qint64 dictionaryStart = 0, dictionaryLength = 0;
+        dictionaryFor(previous, offset, &dictionaryStart, &dictionaryLength);
+        if (dictionaryLength > 0) {
+            ok = inflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(previous.constData() + dictionaryStart),
+                                      uInt(dictionaryLength)) == Z_OK;
+        }
+
+        zs.next_out = reinterpret_cast<Bytef*>(text->data() + offset);
+        zs.avail_out = uInt(length);
+        while (ok && zs.avail_out > 0) {
+            const int result = inflate(&zs, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                ok = zs.avail_out == 0 && offset + length == size;
+                break;
+            }
+            if (result != Z_OK) ok = false;
+        }
+    }
+    inflateEnd(&zs);
+
+    if (!ok) text->clear();
+    return ok;
+}
+
+} // namespace DeltaCodec
@@ -0,0 +1,36 @@
+#ifndef DELTACODEC_H
+#define DELTACODEC_H
+
+#include <QByteArray>
+
+/**
+ * @brief Komprimiert eine Version mit ihrem Vorgänger als deflate-Wörterbuch
+ *
+ * deflate sieht nur 32 KB zurück, bei größeren Notizen findet es den
+ * Vorgänger sonst nicht. Der Text wird daher in Abschnitte zu
+ * SEGMENT_BYTES geteilt; vor jedem Abschnitt wird per
+ * deflateSetDictionary() der Teil des Vorgängers um dieselbe Position als
+ * Wörterbuch gesetzt, mit Spielraum für Einfügungen und Löschungen davor.
+ * Unveränderte Abschnitte schrumpfen so auf wenige Bytes. Zum Dekodieren
+ * genügen die Differenz und der Vorgänger, die Abschnittsgrenzen ergeben
+ * sich aus der Länge.
+ */
+namespace DeltaCodec {
+
+const int SEGMENT_BYTES = 16 * 1024;
+const int WINDOW_BYTES = 32 * 1024;     // Größtes Wörterbuch, das deflate nutzt
+
+/**
+ * @brief Roher deflate-Strom von text, leer bei Fehler oder leerem Text
+ */
+QByteArray encode(const QByteArray& previous, const QByteArray& text);
+
+/**
+ * @brief Stellt text aus Vorgänger und Differenz wieder her
+ * @param size Länge des ursprünglichen Texts in Bytes
+ */
+bool decode(const QByteArray& previous, const QByteArray& delta, qint64 size, QByteArray* text);
+
+} // namespace DeltaCodec
+
+#endif
@@ -0,0 +1,184 @@
+#include "diffdialog.h"
+#include "diffengine.h"
+#include "translations.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QScrollBar>
+#include <QTextCursor>
+#include <QTextBlockFormat>
+#include <QFontDatabase>
+
+namespace {
+
+enum class LineKind { Context, Deleted, Inserted, Padding, Separator };
+
+struct DiffLine {
+    QString text;
+    LineKind kind;
+};
+
+/**
+ * @brief Schreibt die aufbereiteten Zeilen mit passender Hintergrundfarbe in eine Ansicht
+ */
+void fillView(QPlainTextEdit* view, const QVector<DiffLine>& lines)
+{
+    view->clear();
+    QTextCursor cursor(view->document());
+    cursor.beginEditBlock();
+    for (int i = 0; i < lines.size(); ++i) {
+        QTextBlockFormat format;
+        switch (lines[i].kind) {
+        case LineKind::Deleted:
+            format.setBackground(QColor(255, 210, 210));
+            break;
+        case LineKind::Inserted:
+            format.setBackground(QColor(210, 255, 210));
+            break;
+        case LineKind::Padding:
+        case LineKind::Separator:
+            format.setBackground(QColor(235, 235, 235));
+            break;
+        case LineKind::Context:
+            break;
+        }
+        if (i == 0) {
+            cursor.setBlockFormat(format);
+        } else {
+            cursor.insertBlock(format);
+        }
+        cursor.insertText(lines[i].text);
+    }
+    cursor.endEditBlock();
+}
+
+} // namespace
+
+DiffDialog::DiffDialog(int versionCount, std::function<QString(int)> versionText, int oldIndex, int newIndex, QWidget *parent)
+    : QDialog(parent), m_versionText(std::move(versionText))
+{
+    setWindowTitle(Translations::get("compare_versions"));
+    resize(1000, 600);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    // Auswahl der beiden Versionen (1-basiert angezeigt)
+    QHBoxLayout *selectLayout = new QHBoxLayout();
+    m_oldSpin = new QSpinBox(this);
+    m_oldSpin->setRange(1, qMax(1, versionCount));
+    m_oldSpin->setValue(oldIndex + 1);
+    m_newSpin = new QSpinBox(this);
+    m_newSpin->setRange(1, qMax(1, versionCount));
+    m_newSpin->setValue(newIndex + 1);
+    selectLayout->addWidget(new QLabel(Translations::get("version") + ":", this));
+    selectLayout->addWidget(m_oldSpin);
+    selectLayout->addStretch();
+    selectLayout->addWidget(new QLabel(Translations::get("version") + ":", this));
+    selectLayout->addWidget(m_newSpin);
+    layout->addLayout(selectLayout);
+
+    // Ansichten nebeneinander
+    const QFont fixedFont = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    QHBoxLayout *viewLayout = new QHBoxLayout();
+    m_oldView = new QPlainTextEdit(this);
+    m_newView = new QPlainTextEdit(this);
+    for (QPlainTextEdit* view : {m_oldView, m_newView}) {
+        view->setReadOnly(true);
+        view->setLineWrapMode(QPlainTextEdit::NoWrap);
+        view->setFont(fixedFont);
+        viewLayout->addWidget(view);
+    }
+    layout->addLayout(viewLayout, 1);
+
+    // Beide Seiten haben gleich viele Zeilen, daher gemeinsam scrollen
+    connect(m_oldView->verticalScrollBar(), &QScrollBar::valueChanged, m_newView->verticalScrollBar(), &QScrollBar::setValue);
+    connect(m_newView->verticalScrollBar(), &QScrollBar::valueChanged, m_oldView->verticalScrollBar(), &QScrollBar::setValue);
+
+    m_summaryLabel = new QLabel(this);
+    layout->addWidget(m_summaryLabel);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(m_oldSpin, &QSpinBox::valueChanged, this, &DiffDialog::updateDiff);
+    connect(m_newSpin, &QSpinBox::valueChanged, this, &DiffDialog::updateDiff);
+
+    updateDiff();
+}
+
+void DiffDialog::updateDiff()
+{
+    const QString oldText = m_versionText(m_oldSpin->value() - 1);
+    const QString newText = m_versionText(m_newSpin->value() - 1);
+    const QVector<DiffEngine::Hunk> hunks = DiffEngine::diffLines(oldText, newText);
+    const QVector<QStringView> oldLines = DiffEngine::splitLines(oldText);
+    const QVector<QStringView> newLines = DiffEngine::splitLines(newText);
+
+    QVector<DiffLine> left;
+    QVector<DiffLine> right;
+    int deletedCount = 0;
+    int insertedCount = 0;
+
+    const auto numbered = [](int line, QStringView text) {
+        return QStringLiteral("%1  ").arg(line + 1, 6) + text.toString();
+    };
+
+    for (int h = 0; h < hunks.size(); ++h) {
+        const DiffEngine::Hunk& hunk = hunks[h];
+        if (hunk.type == DiffEngine::OpType::Equal) {
+            // Nur Kontextzeilen um die Änderungen herum anzeigen
+            const int headEnd = (h > 0) ? qMin(int(CONTEXT_LINES), hunk.count) : 0;
+            const int tailStart = (h + 1 < hunks.size()) ? qMax(headEnd, hunk.count - CONTEXT_LINES) : hunk.count;
+            for (int i = 0; i < hunk.count; ++i) {
+                if (i == headEnd && tailStart > headEnd) {
+                    left.append({QStringLiteral("    ⋯"), LineKind::Separator});
+                    right.append({QStringLiteral("    ⋯"), LineKind::Separator});
+                    i = tailStart;
+                    if (i >= hunk.count) break;
+                }
+                left.append({numbered(hunk.oldLine + i, oldLines[hunk.oldLine + i]), LineKind::Context});
+                right.append({numbered(hunk.newLine + i, newLines[hunk.newLine + i]), LineKind::Context});
+            }
+            continue;
+        }
+
+        // Gelöschte und direkt folgende eingefügte Zeilen nebeneinander darstellen
+        int deleted = 0;
+        int inserted = 0;
+        int oldStart = hunk.oldLine;
+        int newStart = hunk.newLine;
+        if (hunk.type == DiffEngine::OpType::Delete) {
+            deleted = hunk.count;
+            if (h + 1 < hunks.size() && hunks[h + 1].type == DiffEngine::OpType::Insert) {
+                ++h;
+                inserted = hunks[h].count;
+                newStart = hunks[h].newLine;
+            }
+        } else {
+            inserted = hunk.count;
+        }
+        for (int i = 0; i < qMax(deleted, inserted); ++i) {
+            if (i < deleted) {
+                left.append({numbered(oldStart + i, oldLines[oldStart + i]), LineKind::Deleted});
+            } else {
+                left.append({QString(), LineKind::Padding});
+            }
+            if (i < inserted) {
+                right.append({numbered(newStart + i, newLines[newStart + i]), LineKind::Inserted});
+            } else {
+                right.append({QString(), LineKind::Padding});
+            }
+        }
+        deletedCount += deleted;
+        insertedCount += inserted;
+    }
+
+    fillView(m_oldView, left);
+    fillView(m_newView, right);
+
+    if (deletedCount == 0 && insertedCount == 0) {
+        m_summaryLabel->setText(Translations::get("no_differences"));
+    } else {
+        m_summaryLabel->setText(QStringLiteral("-%1 / +%2").arg(deletedCount).arg(insertedCount));
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef DIFFDIALOG_H
+#define DIFFDIALOG_H
+
+#include <QDialog>
+#include <QPlainTextEdit>
+#include <QSpinBox>
+#include <QLabel>
+#include <functional>
+
+/**
+ * @brief Dialog zum Vergleich zweier History-Versionen nebeneinander
+ */
+class DiffDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor
+     * @param versionCount Anzahl der History-Einträge
+     * @param versionText Liefert den Text zu einem History-Index
+     * @param oldIndex Index der älteren Version (links)
+     * @param newIndex Index der neueren Version (rechts)
+     * @param parent Das übergeordnete Widget
+     */
+    DiffDialog(int versionCount, std::function<QString(int)> versionText, int oldIndex, int newIndex, QWidget *parent = nullptr);
+
+private:
+    static const int CONTEXT_LINES = 3;  // Unveränderte Zeilen um jede Änderung
+
+    std::function<QString(int)> m_versionText;
+    QSpinBox* m_oldSpin;
+    QSpinBox* m_newSpin;
+    QLabel* m_summaryLabel;
+    QPlainTextEdit* m_oldView;
+    QPlainTextEdit* m_newView;
+
+    /**
+     * @brief Berechnet den Vergleich neu und füllt beide Ansichten
+     */
+    void updateDiff();
+};
+
+#endif
@@ -0,0 +1,292 @@
+#include "diffengine.h"
+#include <QHash>
+#include <QtAlgorithms>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define QUICKNOTE_DIFF_SSE2
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define QUICKNOTE_DIFF_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+#ifdef QUICKNOTE_DIFF_AVX2
+bool cpuHasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+QUICKNOTE_DIFF_AVX2
+qsizetype commonPrefixAvx2(const QChar* a, const QChar* b, qsizetype n, qsizetype i)
+{
+    for (; i + 16 <= n; i += 16) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const quint32 mask = ~quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb)));
+        if (mask) return i + qCountTrailingZeroBits(mask) / 2;
+    }
+    return i;
+}
+
+QUICKNOTE_DIFF_AVX2
+qsizetype commonSuffixAvx2(const QChar* a, const QChar* b, qsizetype n, qsizetype i)
+{
+    // i zählt die bereits übereinstimmenden Zeichen vom Ende her
+    for (; i + 16 <= n; i += 16) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + n - i - 16));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + n - i - 16));
+        const quint32 mask = ~quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb)));
+        if (mask) return i + qCountLeadingZeroBits(mask) / 2;
+    }
+    return i;
+}
+#endif
+
+/**
+ * @brief Sucht Zeilenumbrüche und liefert die Startposition jeder Zeile
+ */
+QVector<qsizetype> lineStarts(QStringView text)
+{
+    QVector<qsizetype> starts;
+    starts.append(0);
+    const QChar* data = text.data();
+    const qsizetype n = text.size();
+    qsizetype i = 0;
+#ifdef QUICKNOTE_DIFF_SSE2
+    const __m128i newline = _mm_set1_epi16('\n');
+    for (; i + 8 <= n; i += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_cmpeq_epi16(chunk, newline)));
+        while (mask) {
+            const int bit = qCountTrailingZeroBits(mask);
+            starts.append(i + bit / 2 + 1);
+            mask &= ~(3u << bit);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (data[i] == QLatin1Char('\n')) starts.append(i + 1);
+    }
+    return starts;
+}
+
+/**
+ * @brief Lineare Speichervariante des Myers-Algorithmus
+ *
+ * Markiert gelöschte Zeilen in deleted und eingefügte Zeilen in inserted.
+ * Die Rekursion teilt an der mittleren Schlange, die Tiefe bleibt daher
+ * logarithmisch in der Anzahl der Änderungen.
+ */
+void diffRecursive(const int* e, int N, const int* f, int M, int i, int j,
+                   std::vector<char>& deleted, std::vector<char>& inserted)
+{
+    while (N > 0 && M > 0 && e[0] == f[0]) {
+        ++e; ++f; --N; --M; ++i; ++j;
+    }
+    while (N > 0 && M > 0 && e[N - 1] == f[M - 1]) {
+        --N; --M;
+    }
+    if (N == 0) {
+        for (int n = 0; n < M; ++n) inserted[j + n] = 1;
+        return;
+    }
+    if (M == 0) {
+        for (int n = 0; n < N; ++n) deleted[i + n] = 1;
+        return;
+    }
+
+    const int L = N + M;
+    const int Z = 2 * qMin(N, M) + 2;
+    const int w = N - M;
+    const auto wrap = [Z](int k) { const int r = k % Z; return r < 0 ? r + Z : r; };
+    std::vector<int> g(Z, 0);
+    std::vector<int> p(Z, 0);
+
+    for (int h = 0; h <= L / 2 + (L % 2 != 0); ++h) {
+        for (int r = 0; r < 2; ++r) {
+            std::vector<int>& c = (r == 0) ? g : p;
+            std::vector<int>& d = (r == 0) ? p : g;
+            const int o = (r == 0) ? 1 : 0;
+            const int m = (r == 0) ? 1 : -1;
+            for (int k = -(h - 2 * qMax(0, h - M)); k <= h - 2 * qMax(0, h - N); k += 2) {
+                int a = (k == -h || (k != h && c[wrap(k - 1)] < c[wrap(k + 1)]))
+                        ? c[wrap(k + 1)] : c[wrap(k - 1)] + 1;
+                int b = a - k;
+                const int s = a;
+                const int t = b;
+                while (a < N && b < M
+                       && e[(1 - o) * N + m * a + (o - 1)] == f[(1 - o) * M + m * b + (o - 1)]) {
+                    ++a;
+                    ++b;
+                }
+                c[wrap(k)] = a;
+                const int z = -(k - w);
+                if (L % 2 == o && z >= -(h - o) && z <= h - o && c[wrap(k)] + d[wrap(z)] >= N) {
+                    int D, x, y, u, v;
+                    if (o == 1) {
+                        D = 2 * h - 1; x = s; y = t; u = a; v = b;
+                    } else {
+                        D = 2 * h; x = N - a; y = M - b; u = N - s; v = M - t;
+                    }
+                    // Puffer vor der Rekursion freigeben
+                    std::vector<int>().swap(g);
+                    std::vector<int>().swap(p);
+                    if (D > 1 || (x != u && y != v)) {
+                        diffRecursive(e, x, f, y, i, j, deleted, inserted);
+                        diffRecursive(e + u, N - u, f + v, M - v, i + u, j + v, deleted, inserted);
+                    } else if (M > N) {
+                        diffRecursive(e + N, 0, f + N, M - N, i + N, j + N, deleted, inserted);
+                    } else if (M < N) {
+                        diffRecursive(e + M, N - M, f + M, 0, i + M, j + M, deleted, inserted);
+                    }
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void appendHunk(QVector<DiffEngine::Hunk>& hunks, DiffEngine::OpType type, int oldLine, int newLine, int count)
+{
+    if (count <= 0) return;
+    if (!hunks.isEmpty() && hunks.last().type == type) {
+        hunks.last().count += count;
+        return;
+    }
+    hunks.append({type, oldLine, newLine, count});
+}
+
+} // namespace
+
+qsizetype DiffEngine::commonPrefix(const QChar* a, const QChar* b, qsizetype n)
+{
+    qsizetype i = 0;
+#ifdef QUICKNOTE_DIFF_AVX2
+    if (cpuHasAvx2()) {
+        i = commonPrefixAvx2(a, b, n, i);
+        if (i + 16 <= n) return i;
+    }
+#endif
+#ifdef QUICKNOTE_DIFF_SSE2
+    for (; i + 8 <= n; i += 8) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const quint32 mask = ~quint32(_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb))) & 0xFFFFu;
+        if (mask) return i + qCountTrailingZeroBits(mask) / 2;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return n;
+}
+
+qsizetype DiffEngine::commonSuffix(const QChar* a, const QChar* b, qsizetype n)
+{
+    qsizetype i = 0;
+#ifdef QUICKNOTE_DIFF_AVX2
+    if (cpuHasAvx2()) {
+        i = commonSuffixAvx2(a, b, n, i);
+        if (i + 16 <= n) return i;
+    }
+#endif
+#ifdef QUICKNOTE_DIFF_SSE2
+    for (; i + 8 <= n; i += 8) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + n - i - 8));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + n - i - 8));
+        const quint32 mask = ~quint32(_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb))) & 0xFFFFu;
+        if (mask) return i + (qCountLeadingZeroBits(mask) - 16) / 2;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (a[n - i - 1] != b[n - i - 1]) return i;
+    }
+    return n;
+}
+
+QVector<QStringView> DiffEngine::splitLines(QStringView text)
+{
+    const QVector<qsizetype> starts = lineStarts(text);
+    QVector<QStringView> lines;
+    lines.reserve(starts.size());
+    for (int k = 0; k < starts.size(); ++k) {
+        const qsizetype end = (k + 1 < starts.size()) ? starts[k + 1] - 1 : text.size();
+        lines.append(text.mid(starts[k], end - starts[k]));
+    }
+    return lines;
+}
+
+QVector<DiffEngine::Hunk> DiffEngine::diffLines(const QString& oldText, const QString& newText)
+{
+    const QVector<QStringView> oldLines = splitLines(oldText);
+    const QVector<QStringView> newLines = splitLines(newText);
+    QVector<Hunk> hunks;
+
+    // Gemeinsamen Anfang bis zur letzten vollständigen Zeile abschneiden
+    const qsizetype minLength = qMin(oldText.size(), newText.size());
+    const qsizetype prefix = commonPrefix(oldText.constData(), newText.constData(), minLength);
+    if (prefix == oldText.size() && prefix == newText.size()) {
+        appendHunk(hunks, OpType::Equal, 0, 0, oldLines.size());
+        return hunks;
+    }
+    const qsizetype prefixBoundary = prefix > 0 ? oldText.lastIndexOf(QLatin1Char('\n'), prefix - 1) + 1 : 0;
+    const int prefixLines = int(QStringView(oldText).left(prefixBoundary).count(QLatin1Char('\n')));
+
+    // Das gemeinsame Ende darf sich mit dem Anfang nur im letzten Zeilenumbruch überschneiden
+    const qsizetype suffixLimit = minLength - prefixBoundary + (prefixBoundary > 0 ? 1 : 0);
+    const qsizetype suffix = commonSuffix(oldText.constData() + oldText.size() - suffixLimit,
+                                          newText.constData() + newText.size() - suffixLimit,
+                                          suffixLimit);
+    const int suffixLines = int(QStringView(oldText).right(suffix).count(QLatin1Char('\n')));
+
+    const int oldMiddle = oldLines.size() - prefixLines - suffixLines;
+    const int newMiddle = newLines.size() - prefixLines - suffixLines;
+
+    // Zeilen des Mittelteils über ihren Hash auf Ganzzahlen abbilden
+    QHash<QStringView, int> ids;
+    ids.reserve(oldMiddle + newMiddle);
+    const auto lineId = [&ids](QStringView line) {
+        auto it = ids.constFind(line);
+        if (it == ids.constEnd()) it = ids.insert(line, int(ids.size()));
+        return it.value();
+    };
+    std::vector<int> a(oldMiddle);
+    std::vector<int> b(newMiddle);
+    for (int k = 0; k < oldMiddle; ++k) {
+        a[k] = lineId(oldLines[prefixLines + k]);
+    }
+    for (int k = 0; k < newMiddle; ++k) {
+        b[k] = lineId(newLines[prefixLines + k]);
+    }
+
+    std::vector<char> deleted(oldMiddle, 0);
+    std::vector<char> inserted(newMiddle, 0);
+    diffRecursive(a.data(), oldMiddle, b.data(), newMiddle, 0, 0, deleted, inserted);
+
+    appendHunk(hunks, OpType::Equal, 0, 0, prefixLines);
+    int i = 0;
+    int j = 0;
+    while (i < oldMiddle || j < newMiddle) {
+        if (i < oldMiddle && j < newMiddle && !deleted[i] && !inserted[j]) {
+            appendHunk(hunks, OpType::Equal, prefixLines + i, prefixLines + j, 1);
+            ++i;
+            ++j;
+            continue;
+        }
+        const int deleteStart = i;
+        while (i < oldMiddle && deleted[i]) ++i;
+        appendHunk(hunks, OpType::Delete, prefixLines + deleteStart, prefixLines + j, i - deleteStart);
+        const int insertStart = j;
+        while (j < newMiddle && inserted[j]) ++j;
+        appendHunk(hunks, OpType::Insert, prefixLines + i, prefixLines + insertStart, j - insertStart);
+        if (i == deleteStart && j == insertStart) break;  // Sollte nicht vorkommen
+    }
+    appendHunk(hunks, OpType::Equal, prefixLines + oldMiddle, prefixLines + newMiddle, suffixLines);
+    return hunks;
+}
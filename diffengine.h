@@ -0,0 +1,53 @@
+#ifndef DIFFENGINE_H
+#define DIFFENGINE_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Zeilenbasierter Vergleich zweier Texte nach Myers (lineare Speichervariante)
+ *
+ * Gemeinsame Anfangs- und Endstücke werden vorab mit SIMD (SSE2/AVX2, sonst
+ * skalar) abgeschnitten, danach werden die Zeilen gehasht und nur der
+ * verbleibende Mittelteil verglichen.
+ */
+class DiffEngine {
+public:
+    enum class OpType { Equal, Delete, Insert };
+
+    /**
+     * @brief Ein zusammenhängender Abschnitt des Vergleichsergebnisses
+     *
+     * oldLine/newLine sind die 0-basierten Zeilennummern des Abschnitts im
+     * alten bzw. neuen Text, count die Anzahl der Zeilen.
+     */
+    struct Hunk {
+        OpType type;
+        int oldLine;
+        int newLine;
+        int count;
+    };
+
+    /**
+     * @brief Vergleicht zwei Texte zeilenweise
+     * @return Abschnitte in Dokumentreihenfolge
+     */
+    static QVector<Hunk> diffLines(const QString& oldText, const QString& newText);
+
+    /**
+     * @brief Zerlegt einen Text in Zeilen (ohne Zeilenumbruch)
+     */
+    static QVector<QStringView> splitLines(QStringView text);
+
+    /**
+     * @brief Länge des gemeinsamen Anfangs zweier UTF-16-Puffer
+     */
+    static qsizetype commonPrefix(const QChar* a, const QChar* b, qsizetype n);
+
+    /**
+     * @brief Länge des gemeinsamen Endes zweier UTF-16-Puffer der Länge n
+     */
+    static qsizetype commonSuffix(const QChar* a, const QChar* b, qsizetype n);
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include <QMenu>
 #include <QInputDialog>
 #include <QSettings>
+#include <QSet>
 #include <QColorDialog>
 #include <QKeySequenceEdit>
 #include <QPushButton>
@@ -19,6 +20,12 @@
 #include <QApplication>
 #include <QGuiApplication>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <QProgressDialog>
+#include <QDateTimeEdit>
+#include <QStatusBar>
+#include <QTextDocument>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
 #include <QtGui/qguiapplication_platform.h>
 #else
@@ -30,11 +37,24 @@
 #include <QTimer>
 #include <QSystemTrayIcon>
 #include "translations.h"
+#include "diffdialog.h"
+#include "diffengine.h"
+#include "processmemory.h"
+#include "largepaste.h"
+#include "lineoperations.h"
+#include "allocstats.h"
+#include "fingerprint.h"
+#include "clipboardtext.h"
 #include <QClipboard>
 #include <QGroupBox>
+#include <QCheckBox>
+#include <QLineEdit>
 #include <QSpacerItem>
 #include <QSizePolicy>
 #include <QCryptographicHash>
+#include <QThreadPool>
+#include <QPointer>
+#include <memory>
 
 const QString Editor::SERVER_NAME = "QuickNoteInstance_" + QString(QCryptographicHash::hash("QuickNoteUniqueIdentifier", QCryptographicHash::Sha256).toHex());
 
@@ -57,14 +77,83 @@ void agentDebugLog(const char *hypothesisId, const char *location, const char *m
     }
 }
 // #endregion
+
+const int COMPLETION_HISTORY_SAMPLES = 32;   // Versionen, deren Wörter vorgeschlagen werden
+
+bool s_profileStartup = false;
+QElapsedTimer s_startupClock;
+
+/**
+ * @brief Gibt die Dauer eines Startschritts aus und startet die Messung neu
+ */
+void reportStartupStep(const char* step, QElapsedTimer& timer)
+{
+    if (!s_profileStartup) return;
+    QTextStream out(stdout);
+    out << step << ": " << QString::number(timer.nsecsElapsed() / 1e6, 'f', 2) << " ms" << Qt::endl;
+    timer.restart();
+}
+
+/**
+ * @brief Ergebnis des Ladens im Hintergrund, wird danach in den Editor übernommen
+ */
+struct LoadedHistory {
+    HistoryStore store;
+    UndoTree tree;
+    bool ok = false;
+    qint64 elapsedMs = 0;
+};
+
+/**
+ * @brief Lädt die History und baut den Baum auf, läuft im Thread-Pool
+ */
+void loadHistoryInto(LoadedHistory& loaded, const QString& file)
+{
+    QElapsedTimer timer;
+    timer.start();
+    loaded.ok = loaded.store.load(file);
+    if (loaded.ok && loaded.store.wasRepaired()) {
+        // Bereinigte Datei gleich schreiben, das Original liegt unter .damaged
+        qDebug() << "History teilweise wiederhergestellt:" << loaded.store.errorString();
+        loaded.store.save();
+    }
+    if (loaded.ok) {
+        // Baum aus den Vorgänger-Verweisen aufbauen, ausgelagerte Abschnitte bleiben ungelesen
+        loaded.store.forEachLinks([&loaded](int, const QJsonObject& entry) {
+            loaded.tree.appendEntry(entry);
+            return true;
+        });
+        loaded.tree.activatePath(loaded.store.currentIndex());
+
+        // Einträge älterer Versionen einmalig mit Kennungen versehen
+        if (loaded.tree.needsMigration()) {
+            for (int i = 0; i < loaded.store.size(); ++i) {
+                QJsonObject entry = loaded.store.entry(i);
+                UndoTree::storeLinks(entry, loaded.tree.id(i), loaded.tree.parentId(i), loaded.tree.time(i));
+                loaded.store.replaceEntry(i, entry);
+            }
+            loaded.store.save();
+        }
+    }
+    loaded.elapsedMs = timer.elapsed();
+}
 } // namespace
 
+void Editor::setStartupProfiling(bool enabled)
+{
+    s_profileStartup = enabled;
+}
+
 /**
  * @brief Erstellt und gibt den Pfad zum Datenverzeichnis zurück
  */
 QString Editor::getDataDir() const
 {
-    QString path = QDir::homePath() + "/.local/share/quicknote";
+    // QUICKNOTE_DATA_DIR erlaubt ein separates Verzeichnis, z.B. für Messläufe
+    QString path = qEnvironmentVariable("QUICKNOTE_DATA_DIR");
+    if (path.isEmpty()) {
+        path = QDir::homePath() + "/.local/share/quicknote";
+    }
     QDir dir(path);
     if (!dir.exists()) {
         dir.mkpath(".");
@@ -72,6 +161,18 @@ QString Editor::getDataDir() const
     return path;
 }
 
+/**
+ * @brief Gibt den Namen des lokalen Servers für die Einzelinstanz zurück
+ *
+ * Mit eigenem Datenverzeichnis läuft eine eigene Instanz.
+ */
+QString Editor::getServerName()
+{
+    const QByteArray dataDir = qgetenv("QUICKNOTE_DATA_DIR");
+    if (dataDir.isEmpty()) return SERVER_NAME;
+    return SERVER_NAME + "_" + QString(QCryptographicHash::hash(dataDir, QCryptographicHash::Sha256).toHex().left(16));
+}
+
 /**
  * @brief Gibt den Pfad zur History-Datei zurück
  * @return Absoluter Pfad zur History-Datei im .local/share/quicknote Verzeichnis
@@ -81,135 +182,123 @@ QString Editor::getHistoryFile() const
     return getDataDir() + "/history.gz";
 }
 
+QString Editor::getCurrentStateFile() const
+{
+    return getDataDir() + "/current.state";
+}
+
 /**
  * @brief Konstruktor - Initialisiert den Editor und seine Komponenten
  * @param parent Das übergeordnete Widget
  */
-Editor::Editor(QWidget *parent) : QMainWindow(parent), m_currentHistoryIndex(-1), m_deactivateHistoryEvent(false), m_toggleHotkey(nullptr), m_toggleShortcutFallback(nullptr), m_localServer(nullptr), m_dontSaveSettings(false), m_trayIcon(nullptr)
+Editor::Editor(QWidget *parent) : QMainWindow(parent), m_textEdit(nullptr), m_currentHistoryIndex(-1), m_deactivateHistoryEvent(false), m_toggleHotkey(nullptr), m_toggleShortcutFallback(nullptr), m_localServer(nullptr), m_queryServer(nullptr), m_completer(nullptr), m_wordCompletion(true), m_completionFromHistory(false), m_statusLabel(nullptr), m_showStatusBar(true), m_mirror(nullptr), m_mirrorEnabled(false), m_stateFile(nullptr), m_fingerprintId(-1), m_fingerprint(0), m_dontSaveSettings(false), m_trayIcon(nullptr), m_scrubIndex(-1), m_hibernateTimer(nullptr), m_hibernated(false), m_historyReady(false), m_stateLoaded(false), m_scrollPosition(-1, -1), m_showToPaintMs(-1), m_formatFrom(-1), m_formatTo(-1)
 {
+    s_startupClock.start();
+    QElapsedTimer step;
+    step.start();
+
     setupSingleInstance();
+    reportStartupStep("setupSingleInstance", step);
     if (m_localServer == nullptr) return;  // Beende wenn andere Instanz läuft
     
-    m_textEdit = new QTextEdit(this);
-    setCentralWidget(m_textEdit);
-    
-    // Installiere globalen Event-Filter direkt hier
-    qApp->installEventFilter(this);
+    // Textfeld mit ausblendbarer Suchleiste und Zeitleiste darunter
+    QWidget *central = new QWidget(this);
+    QVBoxLayout *centralLayout = new QVBoxLayout(central);
+    centralLayout->setContentsMargins(0, 0, 0, 0);
+    centralLayout->setSpacing(0);
+    m_textEdit = new NoteTextEdit(central);
+    m_findBar = new FindBar(m_textEdit, central);
+    m_findBar->hide();
+    m_timeline = new TimelineBar(central);
+    m_timeline->hide();
+    centralLayout->addWidget(m_textEdit, 1);
+    centralLayout->addWidget(m_findBar);
+    centralLayout->addWidget(m_timeline);
+    setCentralWidget(central);
+    m_statusLabel = new QLabel(this);
+    statusBar()->addWidget(m_statusLabel, 1);
+
+    // Tastenbelegung gilt nur für Textfeld und Zeitleiste
+    m_keyBindings = new KeyBindings(this);
+    m_keyBindings->installOn(m_textEdit);
+    m_keyBindings->installOn(m_timeline);
+    m_mirror = new MirrorFile(this);
+    m_stateFile = new StateFile(getCurrentStateFile(), this);
     
     loadSettings();
+    reportStartupStep("loadSettings", step);
     applyColors();
     
     setupContextMenu();
     
     m_textEdit->setUndoRedoEnabled(false);
-    m_textEdit->installEventFilter(this);
     
     setWindowTitle("QuickNote");
     setWindowFlags(Qt::Window | Qt::CustomizeWindowHint | Qt::WindowTitleHint | Qt::WindowCloseButtonHint | Qt::WindowStaysOnTopHint | Qt::Tool);
     
+    // Erst der kleine Zustand, die History folgt im Hintergrund
+    step.restart();
     m_deactivateHistoryEvent = true;
-    loadHistory();
+    m_stateLoaded = loadCurrentState();
     m_deactivateHistoryEvent = false;
+    if (m_stateLoaded && m_mirrorEnabled) {
+        m_mirror->update(m_textEdit->toPlainText());  // Die Kopie könnte fehlen oder veraltet sein
+    }
+    reportStartupStep("loadCurrentState", step);
+    loadHistory();
     setupShortcuts();
+    step.restart();
     setupGlobalShortcut();
+    reportStartupStep("setupGlobalShortcut", step);
     
     // Verbinde Textänderungen mit dem Event-Handler
     connect(m_textEdit, &QTextEdit::textChanged, this, &Editor::onTextChanged);
+
+    // Wortvervollständigung, der Wortschatz entsteht erst nach dem Laden der History
+    m_completer = new WordCompleter(m_textEdit->document(), this);
+    connect(m_textEdit, &QTextEdit::textChanged, this, &Editor::updateCompletion);
+    connect(m_textEdit->document(), &QTextDocument::contentsChange, this, &Editor::onContentsChange);
+
+    // Zeilenindex für Statusleiste und Sprung zu einer Zeile, danach nur noch inkrementell
+    m_lineIndex.reset(m_textEdit->document());
+    connect(m_textEdit, &QTextEdit::textChanged, this, &Editor::updateStatusBar);
+    connect(m_textEdit, &QTextEdit::cursorPositionChanged, this, &Editor::updateStatusBar);
+    updateStatusBar();
+    connect(m_textEdit, &NoteTextEdit::largePaste, this, &Editor::pasteLargeText);
+    connect(m_timeline, &TimelineBar::scrubbed, this, &Editor::showScrubVersion);
+    connect(m_timeline, &TimelineBar::committed, this, &Editor::commitScrubVersion);
+    connect(m_findBar, &FindBar::replaceAllRequested, this, &Editor::replaceAll);
+    connect(m_findBar, &FindBar::closed, m_textEdit, qOverload<>(&QWidget::setFocus));
     
+    step.restart();
     setupTrayIcon();
+    reportStartupStep("setupTrayIcon", step);
+
+    // Ruhezustand nach längerer Zeit im Hintergrund
+    m_hibernateTimer = new QTimer(this);
+    m_hibernateTimer->setSingleShot(true);
+    connect(m_hibernateTimer, &QTimer::timeout, this, &Editor::hibernate);
     
+    // Zeitmessung beim Einblenden
+    m_textEdit->viewport()->installEventFilter(this);
+
     // Fenster initial verstecken
     hide();
+    startHibernateTimer();
+    QTimer::singleShot(0, this, &Editor::prewarm);
+    QElapsedTimer total = s_startupClock;
+    reportStartupStep("constructor total", total);
 }
 
 Editor::~Editor()
 {
     saveSettings();
-}
-
-/**
- * @brief Komprimiert Daten mit zlib im gzip-Format
- */
-QByteArray compressData(const QByteArray& data) 
-{
-    // Erstellt einen neuen Puffer für die komprimierten Daten
-    QByteArray compressed;
-    compressed.resize(data.size() + 16);  // Extra Platz für Header und Footer
-    
-    // Initialisiert die zlib-Struktur
-    z_stream zs;
-    zs.zalloc = Z_NULL;
-    zs.zfree = Z_NULL;
-    zs.opaque = Z_NULL;
-    
-    // Initialisiert den Kompressor im gzip-Format
-    deflateInit2(&zs, 
-                1,              // Level 1 = schnellste Kompression
-                Z_DEFLATED,     // Komprimierungsmethode
-                31,            // 15 für normale Kompression + 16 für gzip header
-                8,             // Standard Speicherlevel
-                Z_DEFAULT_STRATEGY);
-    
-    // Setzt die Ein- und Ausgabeparameter
-    zs.avail_in = data.size();
-    zs.next_in = (Bytef*)data.data();
-    zs.avail_out = compressed.size();
-    zs.next_out = (Bytef*)compressed.data();
-    
-    // Führt die Kompression durch
-    deflate(&zs, Z_FINISH);
-    compressed.resize(zs.total_out);
-    deflateEnd(&zs);
-    
-    return compressed;
-}
-
-/**
- * @brief Dekomprimiert gzip-komprimierte Daten
- */
-QByteArray decompressData(const QByteArray& data)
-{
-    if (data.isEmpty()) return QByteArray();
-
-    QByteArray decompressed;
-    const int CHUNK = 16384;
-    decompressed.resize(CHUNK);
-    
-    z_stream zs;
-    zs.zalloc = Z_NULL;
-    zs.zfree = Z_NULL;
-    zs.opaque = Z_NULL;
-    zs.avail_in = data.size();
-    zs.next_in = (Bytef*)data.data();
-    
-    if (inflateInit2(&zs, 47) != Z_OK) {
-        qDebug() << "Fehler bei inflateInit2";
-        return QByteArray();
+    m_store.waitForBackground();    // Danach greift kein Thread mehr auf this zu
+    if (m_localServer) {
+        m_store.flush();  // Falls noch im Hintergrund komprimiert wurde
+        m_mirror->flush();
+        m_stateFile->flush();
     }
-
-    int ret;
-    do {
-        zs.avail_out = CHUNK;
-        zs.next_out = (Bytef*)(decompressed.data() + zs.total_out);
-        
-        ret = inflate(&zs, Z_NO_FLUSH);
-        
-        if (ret < 0) {
-            qDebug() << "Fehler bei inflate:" << ret;
-            inflateEnd(&zs);
-            return QByteArray();
-        }
-        
-        if (zs.avail_out == 0) {
-            decompressed.resize(decompressed.size() + CHUNK);
-        }
-        
-    } while (ret != Z_STREAM_END);
-
-    decompressed.resize(zs.total_out);
-    inflateEnd(&zs);
-    
-    return decompressed;
 }
 
 /**
@@ -218,127 +307,303 @@ QByteArray decompressData(const QByteArray& data)
  * Fügt den aktuellen Text zur History hinzu, wenn er sich vom letzten
  * Zustand unterscheidet. Begrenzt die History auf 100 Einträge.
  * Speichert die History komprimiert.
+ * @param inBackground Komprimierung im Thread-Pool statt synchron
  */
-void Editor::saveHistory()
+void Editor::saveHistory(bool inBackground)
 {
     if (m_deactivateHistoryEvent) return;
 
-    QString currentText = m_textEdit->toPlainText();
+    // Im Ruhezustand ist das Dokument leer, es darf nicht als neue Version gelten
+    if (m_hibernated) {
+        wakeUp();
+    }
+
+    // Eine in der Zeitleiste angezeigte Version ist Ausgangspunkt der Änderung
+    if (m_scrubIndex >= 0) {
+        commitScrubVersion(m_scrubIndex);
+    }
+
     int cursorPos = m_textEdit->textCursor().position();
 
-    // Erstelle JSON-Objekt für den aktuellen Zustand
-    QJsonObject currentState;
-    currentState["text"] = currentText;
-    currentState["cursor"] = cursorPos;
+    // Bis die History geladen ist, genügt die Zustandsdatei
+    if (!m_historyReady) {
+        saveCurrentState(m_textEdit->toPlainText(), cursorPos);
+        return;
+    }
 
-    // Prüfe ob sich der Text oder Cursorposition geändert hat
-    bool shouldSave = m_history.isEmpty();
+    // Prüfe ob sich der Text oder Cursorposition geändert hat, der Text wird dafür nicht gelesen
+    const quint64 fingerprint = m_lineIndex.fingerprint();
+    bool shouldSave = m_store.isEmpty();
     if (!shouldSave && m_currentHistoryIndex >= 0) {
-        QJsonObject lastState = m_history[m_currentHistoryIndex].toObject();
-        shouldSave = lastState["text"].toString() != currentText ||
-                    lastState["cursor"].toInt() != cursorPos;
+        shouldSave = entryFingerprint(m_currentHistoryIndex) != fingerprint ||
+                    m_store.entry(m_currentHistoryIndex)["cursor"].toInt() != cursorPos;
     }
 
     // Wenn sich der Text oder Cursorposition geändert hat, speichere den aktuellen Zustand
     if (shouldSave)
     {
-        // Lösche alle Einträge nach dem aktuellen Index
-        while (m_history.size() > m_currentHistoryIndex + 1) {
-            m_history.removeLast();
+        const QString currentText = m_textEdit->toPlainText();
+        QJsonObject currentState;
+        currentState["text"] = currentText;
+        currentState["cursor"] = cursorPos;
+        currentState["fp"] = Fingerprint::toString(fingerprint);
+
+        // Neuer Eintrag hängt am aktuellen, bestehende Redo-Zweige bleiben erhalten
+        const int parent = m_currentHistoryIndex;
+        const qint64 id = m_undoTree.nextId();
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        UndoTree::storeLinks(currentState, id, parent >= 0 ? m_undoTree.id(parent) : -1, now);
+        m_store.append(currentState);
+        m_undoTree.append(parent, id, now);
+        m_currentHistoryIndex = m_store.size() - 1;
+        m_fingerprintId = id;
+        m_fingerprint = fingerprint;
+
+        applyRetention();
+        while (m_store.size() > m_maxHistorySize) {
+            m_store.removeFirst();
+            m_undoTree.removeFirst();
+            m_retention.removed({0});
+            m_currentHistoryIndex--;
         }
 
-        m_currentHistoryIndex++;
-
-        if (m_history.size() >= m_maxHistorySize) {
-            m_history.removeAt(0);
-            m_currentHistoryIndex--;
+        // Nur geänderte Blöcke und den Index schreiben
+        m_store.setCurrentIndex(m_currentHistoryIndex);
+        saveCurrentState(currentText, cursorPos);
+        if (inBackground) {
+            m_store.saveInBackground(this);
+        } else {
+            m_store.save();
         }
-        
-        m_history.append(currentState);
 
-        // Speichere History und Index getrennt
-        m_state["currentIndex"] = m_currentHistoryIndex;
+        if (m_timeline->isVisible()) {
+            m_timeline->setRange(m_store.size(), m_currentHistoryIndex);
+        }
+    }
+}
 
-        QFile file(getHistoryFile());
-        if (file.open(QIODevice::WriteOnly))
-        {
-            QJsonObject saveData;
-            saveData["history"] = m_history;
-            saveData["state"] = m_state;  // Speichere state separat
-            
-            QJsonDocument doc(saveData);
-            QByteArray data = doc.toJson();
-            QByteArray compressedData = compressData(data);
-            file.write(compressedData);
-            // file.write(data);
-            file.close();
+/**
+ * @brief Fingerprint des Texts einer Version
+ *
+ * Neue Einträge tragen ihn als "fp", bei älteren wird er einmal aus dem
+ * Text berechnet. Gemerkt wird nur der zuletzt verglichene Eintrag, über
+ * seine Kennung im Undo-Baum, die sich beim Ausdünnen nicht verschiebt.
+ */
+quint64 Editor::entryFingerprint(int index)
+{
+    const qint64 id = m_undoTree.id(index);
+    if (id != m_fingerprintId) {
+        const QJsonObject entry = m_store.entry(index);
+        if (!Fingerprint::fromString(entry["fp"].toString(), &m_fingerprint)) {
+            m_fingerprint = Fingerprint::ofNote(entry["text"].toString());
         }
+        m_fingerprintId = id;
+    }
+    return m_fingerprint;
+}
+
+/**
+ * @brief Dünnt alte Versionen nach der eingestellten Aufbewahrung aus
+ *
+ * Läuft nach jedem neuen Eintrag und prüft nur Versionen, die seitdem eine
+ * Altersgrenze überschritten haben. Entfernt wird aber erst ab
+ * RetentionPolicy::BATCH_SIZE Kandidaten, damit die Datei nur selten ab
+ * dem ersten betroffenen Block neu geschrieben wird.
+ */
+void Editor::applyRetention()
+{
+    const QList<int> removals = m_retention.removable(m_undoTree, m_currentHistoryIndex, QDateTime::currentMSecsSinceEpoch());
+    if (removals.size() < RetentionPolicy::BATCH_SIZE) return;
+
+    int removedBeforeCurrent = 0;
+    for (int index : removals) {
+        if (index < m_currentHistoryIndex) ++removedBeforeCurrent;
+    }
+
+    // Nachfolger entfernter Versionen hängen danach am nächsten verbliebenen Vorfahren
+    const QList<QPair<int, qint64>> reparented = m_undoTree.remove(removals);
+    m_store.removeEntries(removals);
+    for (const QPair<int, qint64>& link : reparented) {
+        QJsonObject entry = m_store.entry(link.first);
+        UndoTree::storeLinks(entry, m_undoTree.id(link.first), link.second, m_undoTree.time(link.first));
+        m_store.replaceEntry(link.first, entry);
     }
+    m_retention.removed(removals);
+
+    m_currentHistoryIndex -= removedBeforeCurrent;
 }
 
 /**
- * @brief Lädt die gespeicherte History aus der JSON-Datei
+ * @brief Lädt die gespeicherte History aus der History-Datei
  * 
- * Liest die komprimierte History-Datei und dekomprimiert sie.
+ * Das Laden läuft im Thread-Pool in einen eigenen Store, die Blöcke der
+ * Datei werden dabei parallel dekomprimiert. Der Text steht bis dahin schon
+ * aus der Zustandsdatei im Fenster.
  */
 void Editor::loadHistory()
 {
-    QFile file(getHistoryFile());
-    if (file.open(QIODevice::ReadOnly))
-    {
-        QByteArray compressedData = file.readAll();
-        QByteArray data = decompressData(compressedData);
-        // QByteArray data = file.readAll();
-
-        // Überprüfe, ob die Daten gültig sind
-        if (data.isEmpty()) {
-            qDebug() << "Fehler: Dekomprimierte Daten sind leer";
-            file.close();
-            return;
-        }
+    auto loaded = std::make_shared<LoadedHistory>();
+    const QPointer<Editor> editor(this);
+    const QString file = getHistoryFile();
+    QThreadPool::globalInstance()->start([loaded, editor, file]() {
+        loadHistoryInto(*loaded, file);
+        QMetaObject::invokeMethod(qApp, [loaded, editor]() {
+            if (!editor) return;
+            if (s_profileStartup) {
+                QTextStream(stdout) << "loadHistory: " << loaded->elapsedMs << " ms in background, ready after "
+                                    << s_startupClock.elapsed() << " ms" << Qt::endl;
+            }
+            editor->finishHistoryLoad(loaded->store, loaded->tree, loaded->ok);
+        }, Qt::QueuedConnection);
+    });
+}
 
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-        
-        
-        if (parseError.error != QJsonParseError::NoError) {
-            qDebug() << "JSON Parse Fehler:" << parseError.errorString();
-            file.close();
-            return;
-        }
-        
-        if (!doc.isObject()) {
-            qDebug() << "Fehler: JSON-Dokument ist kein Objekt";
-            file.close();
-            return;
-        }
-        
-        QJsonObject saveData = doc.object();
-        
-        // Überprüfe, ob die erwarteten Schlüssel existieren
-        if (!saveData.contains("history") || !saveData["history"].isArray()) {
-            qDebug() << "Fehler: Keine gültige History in den Daten gefunden";
-            qDebug() << "SaveData:" << saveData;
-            file.close();
-            return;
-        }
-        
-        m_history = saveData["history"].toArray();
-        m_state = saveData["state"].toObject();
-        m_currentHistoryIndex = m_state["currentIndex"].toInt();
-        
-        if (m_currentHistoryIndex >= 0 && m_currentHistoryIndex < m_history.size()) {
-            QJsonObject currentHistory = m_history[m_currentHistoryIndex].toObject();
-            m_textEdit->setText(currentHistory["text"].toString());
-            
-            QTextCursor cursor = m_textEdit->textCursor();
-            auto cursorPos = currentHistory["cursor"].toInt();
-            cursor.setPosition(cursorPos);
-            m_textEdit->setTextCursor(cursor);
+/**
+ * @brief Übernimmt die geladene History und schaltet Undo frei
+ *
+ * Änderungen während des Ladens und ein Stand aus der Zustandsdatei, der
+ * neuer als die History ist, werden danach als neuer Eintrag gespeichert.
+ */
+void Editor::finishHistoryLoad(HistoryStore& store, UndoTree& tree, bool ok)
+{
+    if (!ok && QFile::exists(getHistoryFile())) {
+        qDebug() << "Fehler beim Laden der History:" << store.errorString();
+    }
+
+    m_store = std::move(store);
+    m_undoTree = std::move(tree);
+    m_retention.reset();
+    m_fingerprintId = -1;
+    m_currentHistoryIndex = ok ? m_store.currentIndex() : -1;
+    m_historyReady = true;
+
+    // Die Zustandsdatei wird verzögert geschrieben, nach einem Absturz kann die History neuer sein
+    const bool validIndex = m_currentHistoryIndex >= 0 && m_currentHistoryIndex < m_store.size();
+    const bool historyNewer = m_stateLoaded && validIndex
+        && m_undoTree.time(m_currentHistoryIndex) > m_stateFile->savedAt();
+    if ((!m_stateLoaded && m_textEdit->document()->isEmpty()) || historyNewer) {
+        // Ohne Zustandsdatei, z.B. beim ersten Start nach einem Update, oder mit veralteter
+        if (validIndex) {
+            restoreHistoryEntry(m_currentHistoryIndex);
         }
-        
-        file.close();
+    } else {
+        saveHistory();
     }
+
+    if (m_timeline->isVisible()) {
+        m_timeline->setRange(m_store.size(), m_currentHistoryIndex);
+    }
+    m_completer->setEnabled(m_wordCompletion);
+    loadCompletionVocabulary();
+    updateStatusBar();
+    emit historyReady();
+}
+
+/**
+ * @brief Zeigt die Vervollständigung für das gerade getippte Wort an
+ */
+void Editor::updateCompletion()
+{
+    const QTextCursor cursor = m_textEdit->textCursor();
+    if (m_deactivateHistoryEvent || m_textEdit->isReadOnly() || cursor.hasSelection()) {
+        m_textEdit->setCompletion(QString());
+        return;
+    }
+    m_textEdit->setCompletion(m_completer->suggestion(cursor.position()));
+}
+
+/**
+ * @brief Liest Zeile und Spalte aus dem Zeilenindex statt aus dem Text
+ */
+void Editor::updateStatusBar()
+{
+    if (!m_showStatusBar || m_hibernated) return;
+    const int position = m_textEdit->textCursor().position();
+    const int line = m_lineIndex.lineAt(position);
+    const qint64 column = position - m_lineIndex.lineStart(line);
+    QString text = Translations::get("line_column").arg(line + 1).arg(column + 1)
+        + "  |  " + Translations::get("characters_count").arg(qMax<qint64>(0, m_lineIndex.length() - 1));
+    const int version = m_scrubIndex >= 0 ? m_scrubIndex : m_currentHistoryIndex;
+    if (m_historyReady && version >= 0) {
+        text += QString("  |  %1 %2 / %3").arg(Translations::get("version")).arg(version + 1).arg(m_store.size());
+    }
+    m_statusLabel->setText(text);
+}
+
+/**
+ * @brief Springt zum Anfang einer Zeile, die Position liefert der Zeilenindex
+ */
+void Editor::goToLine()
+{
+    const int current = m_lineIndex.lineAt(m_textEdit->textCursor().position()) + 1;
+    bool ok = false;
+    const int line = QInputDialog::getInt(this, Translations::get("go_to_line"), Translations::get("line") + ":",
+                                          current, 1, qMax(1, m_lineIndex.lineCount()), 1, &ok);
+    if (!ok) return;
+    QTextCursor cursor = m_textEdit->textCursor();
+    cursor.setPosition(int(m_lineIndex.lineStart(line - 1)));
+    m_textEdit->setTextCursor(cursor);
+    m_textEdit->ensureCursorVisible();
+    m_textEdit->setFocus();
+}
+
+/**
+ * @brief Sammelt die Wörter einiger älterer Versionen im Thread-Pool
+ *
+ * Aufeinanderfolgende Versionen unterscheiden sich kaum, daher wird nur jede
+ * HistoryStore::BLOCK_ENTRIES-te gelesen, jeweils ein Block auf einmal.
+ */
+void Editor::loadCompletionVocabulary()
+{
+    if (!m_completionFromHistory || !m_completer->isEnabled() || !m_historyReady || m_store.isEmpty()) return;
+
+    HistoryStore store = m_store.snapshot();
+    QPointer<Editor> guard(this);
+    QThreadPool::globalInstance()->start([store, guard]() mutable {
+        auto vocabulary = std::make_shared<WordTrie>();
+        QSet<QString> words;
+        int index = store.size() - 1;
+        for (int sample = 0; sample < COMPLETION_HISTORY_SAMPLES && index >= 0; ++sample) {
+            words.clear();
+            WordCompleter::forEachWord(store.entry(index)["text"].toString(),
+                                       [&words](QStringView word) { words.insert(word.toString()); });
+            for (const QString& word : words) vocabulary->insert(word);
+            store.releaseCache();
+            index -= HistoryStore::BLOCK_ENTRIES;
+        }
+        if (!guard) return;
+        QMetaObject::invokeMethod(guard.data(), [guard, vocabulary]() {
+            if (guard) guard->m_completer->setHistoryVocabulary(vocabulary);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Liest Text und Cursor aus der Zustandsdatei
+ */
+bool Editor::loadCurrentState()
+{
+    QString text;
+    int cursorPos = 0;
+    if (!m_stateFile->read(&text, &cursorPos)) return false;
+
+    m_textEdit->setText(text);
+    QTextCursor cursor = m_textEdit->textCursor();
+    cursor.setPosition(qBound(0, int(cursorPos), m_textEdit->document()->characterCount() - 1));
+    m_textEdit->setTextCursor(cursor);
+    return true;
+}
+
+/**
+ * @brief Merkt Text und Cursor für die Zustandsdatei und die Textkopie vor
+ *
+ * Beide werden verzögert im Thread-Pool geschrieben, ein Tastendruck kostet
+ * hier nur das Teilen des Texts.
+ */
+void Editor::saveCurrentState(const QString& text, int cursorPos)
+{
+    m_stateFile->update(text, cursorPos);
+    m_mirror->update(text);
 }
 
 /**
@@ -353,144 +618,341 @@ void Editor::onTextChanged()
     if (isFormatting) return;  // Vermeide rekursive Aufrufe
 
     isFormatting = true;
+    const AllocStats::Scope allocations;  // Nur mit QUICKNOTE_ALLOC_STATS aktiv
 
     saveHistory(); 
 
-    // Erstelle einen Textcursor für den gesamten Text
-    QTextCursor cursor = m_textEdit->textCursor();
-    int originalPosition = cursor.position();  // Speichere die ursprüngliche Cursor-Position
-    cursor.select(QTextCursor::Document);
-
-    // Erstelle das Standardformat
-    QTextCharFormat format;
-    format.setForeground(m_textColor);
-    format.setBackground(m_backgroundColor);
-    format.setFontPointSize(m_fontSize); 
-
-    // Wende das Format auf den gesamten Text an
-    cursor.setCharFormat(format);
-
-    // Setze den Cursor zurück an die ursprüngliche Position
-    cursor.setPosition(originalPosition);
-    m_textEdit->setTextCursor(cursor);
+    // Standardformat nur auf den geänderten Bereich anwenden, bei großen
+    // Notizen würde sonst jeder Tastendruck das ganze Dokument neu formatieren
+    if (m_formatFrom >= 0) {
+        const int last = m_textEdit->document()->characterCount() - 1;
+        QTextCursor cursor(m_textEdit->document());
+        cursor.setPosition(qMin(m_formatFrom, last));
+        cursor.setPosition(qMin(m_formatTo, last), QTextCursor::KeepAnchor);
+        cursor.setCharFormat(textFormat());
+        m_formatFrom = -1;
+        m_formatTo = -1;
+    }
 
+    AllocStats::recordKeystroke(allocations.elapsed());
     isFormatting = false;
 }
 
 /**
- * @brief Richtet die Tastenkombinationen für den Editor ein
+ * @brief Merkt sich den geänderten Bereich für das nächste Formatieren und führt den Zeilenindex nach
+ */
+void Editor::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    m_lineIndex.update(m_textEdit->document(), position, charsRemoved, charsAdded);
+    if (m_formatFrom < 0) {
+        m_formatFrom = position;
+        m_formatTo = position + charsAdded;
+        return;
+    }
+    if (m_formatTo > position) {
+        m_formatTo = qMax(position + charsAdded, m_formatTo + charsAdded - charsRemoved);
+    }
+    m_formatFrom = qMin(m_formatFrom, position);
+    m_formatTo = qMax(m_formatTo, position + charsAdded);
+}
+
+/**
+ * @brief Verbindet die Befehle der Tastenbelegung mit dem Editor
  * 
- * Konfiguriert Shortcuts für:
+ * Standardbelegung (änderbar in settings.conf, Gruppe [keybindings]):
+ * - Strg+Z: Undo
+ * - Strg+Y, Strg+Shift+Z: Redo
+ * - Strg+C / Strg+X: Kopieren / Ausschneiden als reiner Text
  * - Strg+L: Trennlinie einfügen
+ * - Strg+T: Zeitleiste ein-/ausblenden
+ * - Strg+Alt+S/U/F/R: Zeilen sortieren, Duplikate entfernen, filtern, umkehren
+ * - Strg+F: Suchleiste
+ * - Strg+G: Zu Zeile springen
  */
 void Editor::setupShortcuts()
 {
-    // Trennlinie einfügen (Strg+L)
-    QAction* lineAction = new QAction("Line", m_textEdit);  // Parent ist m_textEdit
-    lineAction->setShortcut(Qt::CTRL | Qt::Key_L);
-    lineAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);  // Wichtig!
-    m_textEdit->addAction(lineAction);  // Action zum TextEdit
-    connect(lineAction, &QAction::triggered, [this]() {
+    m_keyBindings->setHandler(KeyBindings::Undo, [this]() { executeUndo(); });
+    m_keyBindings->setHandler(KeyBindings::Redo, [this]() { executeRedo(); });
+    m_keyBindings->setHandler(KeyBindings::Copy, [this]() { onCopy(); });
+    m_keyBindings->setHandler(KeyBindings::Cut, [this]() { onCut(); });
+    m_keyBindings->setHandler(KeyBindings::InsertLine, [this]() {
+        if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
         QTextCursor cursor = m_textEdit->textCursor();
         cursor.movePosition(QTextCursor::EndOfLine);
         cursor.insertText("\n----------------------------------------------------------------------------\n");
         m_textEdit->setTextCursor(cursor);
     });
+    m_keyBindings->setHandler(KeyBindings::ToggleTimeline, [this]() { toggleTimeline(); });
+    m_keyBindings->setHandler(KeyBindings::SortLines, [this]() {
+        applyLineOperation([](const QString& text) { return LineOperations::sortLines(text); });
+    });
+    m_keyBindings->setHandler(KeyBindings::UniqueLines, [this]() {
+        applyLineOperation([](const QString& text) { return LineOperations::uniqueLines(text); });
+    });
+    m_keyBindings->setHandler(KeyBindings::FilterLines, [this]() { filterLines(); });
+    m_keyBindings->setHandler(KeyBindings::ReverseLines, [this]() {
+        applyLineOperation([](const QString& text) { return LineOperations::reverseLines(text); });
+    });
+    m_keyBindings->setHandler(KeyBindings::Find, [this]() { m_findBar->activate(); });
+    m_keyBindings->setHandler(KeyBindings::GoToLine, [this]() { goToLine(); });
 }
 
 /**
- * @brief Führt eine Redo-Operation aus
- * 
- * Stellt den nächsten Zustand aus der History wieder her,
- * falls verfügbar.
+ * @brief Blendet die Zeitleiste ein oder aus
+ *
+ * Beim Ausblenden wird eine nur angezeigte Version übernommen.
  */
-void Editor::executeRedo()
+void Editor::toggleTimeline()
 {
-    if (m_currentHistoryIndex < m_history.size() - 1) {
-        m_deactivateHistoryEvent = true;
-        m_currentHistoryIndex++;
-        
-        QJsonObject state = m_history[m_currentHistoryIndex].toObject();
-        m_textEdit->setText(state["text"].toString());
-        
-        QTextCursor cursor = m_textEdit->textCursor();
-        cursor.setPosition(state["cursor"].toInt());
-        m_textEdit->setTextCursor(cursor);
-        
-        m_deactivateHistoryEvent = false;
-        saveHistoryIndex();  // Statt saveHistory()
+    if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
+    if (m_timeline->isVisible()) {
+        commitScrubVersion(m_scrubIndex);
+        m_timeline->setRange(m_store.size(), m_currentHistoryIndex);  // Stoppt ausstehende Signale
+        m_timeline->hide();
+        m_textEdit->setFocus();
+    } else {
+        m_timeline->setRange(m_store.size(), m_currentHistoryIndex);
+        m_timeline->show();
     }
 }
 
 /**
- * @brief Führt eine Undo-Operation aus
- * 
- * Stellt den vorherigen Zustand aus der History wieder her,
- * falls verfügbar. Verhindert dabei das Hinzufügen des
- * wiederhergestellten Zustands zur History.
+ * @brief Zeigt eine Version beim Ziehen der Zeitleiste an
+ *
+ * Es wird nur der geänderte Mittelteil des Dokuments ersetzt, damit Layout
+ * und Formatierung für den Rest erhalten bleiben. Die History und der
+ * gespeicherte Index bleiben unverändert, bis die Version übernommen wird.
  */
-void Editor::executeUndo()
+void Editor::showScrubVersion(int index)
 {
-    if (m_currentHistoryIndex > 0) {
-        m_deactivateHistoryEvent = true;
-        m_currentHistoryIndex--;
-        
-        QJsonObject state = m_history[m_currentHistoryIndex].toObject();
-        m_textEdit->setText(state["text"].toString());
-        
-        QTextCursor cursor = m_textEdit->textCursor();
-        cursor.setPosition(state["cursor"].toInt());
-        m_textEdit->setTextCursor(cursor);
-        
-        m_deactivateHistoryEvent = false;
-        saveHistoryIndex();  // Statt saveHistory()
-    }
+    if (index < 0 || index >= m_store.size() || m_textEdit->isReadOnly()) return;
+
+    // Nachbarblöcke vorab dekodieren, damit weiteres Ziehen flüssig bleibt
+    m_store.prefetch(index - HistoryStore::BLOCK_ENTRIES, index + HistoryStore::BLOCK_ENTRIES);
+    replaceTextMinimal(m_store.entry(index)["text"].toString());
+    m_scrubIndex = index;
 }
 
 /**
- * @brief Filtert Tastatur-Events für Undo/Redo
- * 
- * Verarbeitet:
- * - Strg+Z: Undo
- * - Strg+Shift+Z: Redo
- * - Strg+Y: Alternative Redo
- * 
- * @param obj Das Objekt, das das Event empfängt
- * @param event Das zu verarbeitende Event
- * @return true wenn Event verarbeitet wurde, sonst false
+ * @brief Fragt nach einem Zeitpunkt und stellt die damals aktuelle Version wieder her
+ *
+ * Die Version wird über den Zeitindex der History binär gesucht, gelesen
+ * wird nur die gefundene Version. Wie in der Zeitleiste wird sie zum
+ * aktuellen Stand, ohne einen neuen Eintrag anzulegen.
  */
-bool Editor::eventFilter(QObject *obj, QEvent *event)
+void Editor::restoreToTime()
 {
+    if (!m_historyReady || m_store.isEmpty() || m_textEdit->isReadOnly()) return;
 
-    // Shortcuts nur bei aktivem Fenster
-    if (obj == m_textEdit && isActiveWindow()) {
-        if (event->type() == QEvent::KeyPress) {
-            QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+    const auto formatTime = [](qint64 msecs) {
+        return msecs > 0 ? QDateTime::fromMSecsSinceEpoch(msecs).toString("yyyy-MM-dd HH:mm:ss") : QString("?");
+    };
 
-            if (keyEvent->matches(QKeySequence::Undo)) {
-                executeUndo();
-                return true;
-            }
-            else if (keyEvent->matches(QKeySequence::Redo)) {
-                executeRedo();
-                return true;
-            }
-            else if (keyEvent->modifiers() == Qt::CTRL && keyEvent->key() == Qt::Key_Y) {
-                executeRedo();
-                return true;
-            }
-            else if (keyEvent->matches(QKeySequence::Copy)) {
-                onCopy();
-                return true;
-            }
-            else if (keyEvent->matches(QKeySequence::Cut)) {
-                onCut();
-                return true;
-            }
+    QDialog dialog(this);
+    dialog.setWindowTitle(Translations::get("restore_to_time"));
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    QDateTimeEdit *timeEdit = new QDateTimeEdit(QDateTime::currentDateTime(), &dialog);
+    timeEdit->setCalendarPopup(true);
+    timeEdit->setDisplayFormat("yyyy-MM-dd HH:mm:ss");
+    layout->addWidget(timeEdit);
+    QLabel *versionLabel = new QLabel(&dialog);
+    layout->addWidget(versionLabel);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    int target = -1;
+    const auto updateVersion = [&]() {
+        target = m_store.versionAt(timeEdit->dateTime().toMSecsSinceEpoch());
+        buttons->button(QDialogButtonBox::Ok)->setEnabled(target >= 0);
+        versionLabel->setText(target < 0 ? Translations::get("no_version_at_time")
+            : QString("%1 %2 / %3, %4").arg(Translations::get("version")).arg(target + 1)
+                  .arg(m_store.size()).arg(formatTime(m_store.timeOf(target))));
+    };
+    connect(timeEdit, &QDateTimeEdit::dateTimeChanged, &dialog, updateVersion);
+    updateVersion();
+
+    if (dialog.exec() != QDialog::Accepted || target < 0 || target >= m_store.size()) return;
+    showScrubVersion(target);
+    commitScrubVersion(target);
+}
+
+/**
+ * @brief Übernimmt die in der Zeitleiste angezeigte Version als aktuellen Stand
+ */
+void Editor::commitScrubVersion(int index)
+{
+    if (m_scrubIndex < 0 || index < 0 || index >= m_store.size()) return;
+    m_scrubIndex = -1;
+    m_currentHistoryIndex = index;
+    m_undoTree.activatePath(index);
+
+    QTextCursor cursor = m_textEdit->textCursor();
+    cursor.setPosition(qMin(m_store.entry(index)["cursor"].toInt(), m_textEdit->document()->characterCount() - 1));
+    m_textEdit->setTextCursor(cursor);
+
+    saveHistoryIndex();
+}
+
+/**
+ * @brief Ersetzt den Text, ändert aber nur den Bereich zwischen gemeinsamem Anfang und Ende
+ */
+void Editor::replaceTextMinimal(const QString& text)
+{
+    const QString current = m_textEdit->toPlainText();
+    const qsizetype limit = qMin(current.size(), text.size());
+    const qsizetype prefix = DiffEngine::commonPrefix(current.constData(), text.constData(), limit);
+    const qsizetype rest = limit - prefix;
+    const qsizetype suffix = DiffEngine::commonSuffix(current.constData() + current.size() - rest,
+                                                      text.constData() + text.size() - rest, rest);
+    if (prefix == current.size() && prefix == text.size()) return;
+
+    // Ohne textChanged, damit weder History noch Neuformatierung ausgelöst werden
+    const bool blocked = m_textEdit->blockSignals(true);
+    QTextCursor cursor(m_textEdit->document());
+    cursor.setPosition(prefix);
+    cursor.setPosition(current.size() - suffix, QTextCursor::KeepAnchor);
+    cursor.insertText(text.mid(prefix, text.size() - prefix - suffix), textFormat());
+    m_textEdit->blockSignals(blocked);
+    m_formatFrom = -1;  // Bereits im Standardformat eingefügt
+    m_formatTo = -1;
+}
+
+/**
+ * @brief Übernimmt das Ergebnis von "Alle ersetzen" als einen History-Eintrag
+ */
+void Editor::replaceAll(const QString& text)
+{
+    if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
+    commitScrubVersion(m_scrubIndex);
+    const int cursorPos = m_textEdit->textCursor().position();
+    replaceTextMinimal(text);
+    QTextCursor cursor = m_textEdit->textCursor();
+    cursor.setPosition(qMin(cursorPos, m_textEdit->document()->characterCount() - 1));
+    m_textEdit->setTextCursor(cursor);
+    saveHistory();
+}
+
+/**
+ * @brief Wendet eine Zeilenoperation auf die ausgewählten Zeilen oder den ganzen Text an
+ *
+ * Eine Auswahl wird auf ganze Zeilen erweitert. Das Ergebnis ersetzt nur den
+ * geänderten Bereich und wird als ein einziger History-Eintrag gespeichert.
+ */
+void Editor::applyLineOperation(const std::function<QString(const QString&)>& operation)
+{
+    if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
+    commitScrubVersion(m_scrubIndex);
+
+    const QString text = m_textEdit->toPlainText();
+    const QTextCursor selection = m_textEdit->textCursor();
+    qsizetype start = 0;
+    qsizetype end = text.size();
+    if (selection.hasSelection()) {
+        const qsizetype selectionStart = selection.selectionStart();
+        const qsizetype selectionEnd = selection.selectionEnd();
+        start = selectionStart > 0 ? text.lastIndexOf(u'\n', selectionStart - 1) + 1 : 0;
+        if (selectionEnd > selectionStart && text[selectionEnd - 1] == u'\n') {
+            end = selectionEnd - 1;  // Auswahl endet am Anfang der nächsten Zeile
+        } else {
+            end = text.indexOf(u'\n', selectionEnd);
+            if (end < 0) end = text.size();
         }
     }
 
-    return QMainWindow::eventFilter(obj, event);
+    const QString result = operation(text.mid(start, end - start));
+    replaceTextMinimal(text.left(start) + result + text.mid(end));
+
+    // Bearbeitete Zeilen ausgewählt lassen
+    QTextCursor cursor(m_textEdit->document());
+    cursor.setPosition(start);
+    cursor.setPosition(start + result.size(), QTextCursor::KeepAnchor);
+    m_textEdit->setTextCursor(cursor);
+    saveHistory();
+}
+
+/**
+ * @brief Fragt nach einem regulären Ausdruck und filtert die Zeilen damit
+ */
+void Editor::filterLines()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(Translations::get("filter_lines"));
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(Translations::get("filter_pattern"), &dialog));
+    QLineEdit *patternEdit = new QLineEdit(m_lastFilterPattern, &dialog);
+    layout->addWidget(patternEdit);
+    QCheckBox *removeCheck = new QCheckBox(Translations::get("filter_remove"), &dialog);
+    layout->addWidget(removeCheck);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    const QRegularExpression pattern(patternEdit->text());
+    if (!pattern.isValid()) {
+        QMessageBox::warning(this, Translations::get("filter_lines"),
+                             Translations::get("invalid_regex") + ":\n" + pattern.errorString());
+        return;
+    }
+    m_lastFilterPattern = patternEdit->text();
+    const bool keepMatching = !removeCheck->isChecked();
+    applyLineOperation([pattern, keepMatching](const QString& text) {
+        return LineOperations::filterLines(text, pattern, keepMatching);
+    });
+}
+
+/**
+ * @brief Zeigt einen Eintrag der History an, ohne einen neuen anzulegen
+ * @param index Index des Eintrags
+ */
+void Editor::restoreHistoryEntry(int index)
+{
+    if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
+    m_deactivateHistoryEvent = true;
+    m_scrubIndex = -1;
+    m_currentHistoryIndex = index;
+
+    QJsonObject state = m_store.entry(m_currentHistoryIndex);
+    m_textEdit->setText(state["text"].toString());
+
+    QTextCursor cursor = m_textEdit->textCursor();
+    cursor.setPosition(state["cursor"].toInt());
+    m_textEdit->setTextCursor(cursor);
+
+    m_deactivateHistoryEvent = false;
+    saveHistoryIndex();  // Statt saveHistory()
+}
+
+/**
+ * @brief Führt eine Redo-Operation aus
+ * 
+ * Stellt den Nachfolger im zuletzt aktiven Zweig wieder her,
+ * falls verfügbar.
+ */
+void Editor::executeRedo()
+{
+    const int next = m_undoTree.redoTarget(m_currentHistoryIndex);
+    if (next >= 0) {
+        restoreHistoryEntry(next);
+    }
+}
+
+/**
+ * @brief Führt eine Undo-Operation aus
+ * 
+ * Stellt den Vorgänger des aktuellen Zustands wieder her,
+ * falls verfügbar. Verhindert dabei das Hinzufügen des
+ * wiederhergestellten Zustands zur History.
+ */
+void Editor::executeUndo()
+{
+    const int parent = m_undoTree.parent(m_currentHistoryIndex);
+    if (parent >= 0) {
+        restoreHistoryEntry(parent);
+    }
 }
 
 void Editor::setupContextMenu()
@@ -499,6 +961,63 @@ void Editor::setupContextMenu()
     connect(m_textEdit, &QWidget::customContextMenuRequested, this, [this](const QPoint &pos) {
         QMenu *menu = m_textEdit->createStandardContextMenu();
         
+        menu->addSeparator();
+
+        // Zwei History-Versionen vergleichen
+        QAction *compareAction = menu->addAction(Translations::get("compare_versions"));
+        compareAction->setEnabled(m_store.size() > 1);
+        connect(compareAction, &QAction::triggered, this, [this]() {
+            const int newIndex = qMax(0, m_currentHistoryIndex);
+            const int parent = m_undoTree.parent(newIndex);
+            DiffDialog dialog(m_store.size(), [this](int index) {
+                return m_store.entry(index)["text"].toString();
+            }, parent >= 0 ? parent : qMax(0, newIndex - 1), newIndex, this);
+            dialog.exec();
+        });
+
+        QAction *timelineAction = menu->addAction(Translations::get("timeline"));
+        timelineAction->setCheckable(true);
+        timelineAction->setChecked(m_timeline->isVisible());
+        timelineAction->setEnabled(!m_textEdit->isReadOnly());
+        connect(timelineAction, &QAction::triggered, this, &Editor::toggleTimeline);
+
+        QAction *restoreTimeAction = menu->addAction(Translations::get("restore_to_time"));
+        restoreTimeAction->setEnabled(m_historyReady && !m_store.isEmpty() && !m_textEdit->isReadOnly());
+        connect(restoreTimeAction, &QAction::triggered, this, &Editor::restoreToTime);
+
+        // Zwischen den Zweigen an der nächsten Verzweigung wechseln
+        int currentBranch = -1;
+        const QList<int> branches = m_undoTree.branchesAt(m_currentHistoryIndex, &currentBranch);
+        QMenu *branchMenu = menu->addMenu(Translations::get("branches"));
+        branchMenu->setEnabled(branches.size() > 1 && !m_textEdit->isReadOnly());
+        for (int b = 0; b < branches.size(); ++b) {
+            const QString preview = m_store.entry(m_undoTree.tip(branches[b]))["text"].toString().simplified().right(40);
+            QAction *branchAction = branchMenu->addAction(
+                QString("%1 %2: %3").arg(Translations::get("branch")).arg(b + 1).arg(preview));
+            branchAction->setCheckable(true);
+            branchAction->setChecked(branches[b] == currentBranch);
+            const int start = branches[b];
+            connect(branchAction, &QAction::triggered, this, [this, start]() {
+                const int target = m_undoTree.tip(start);
+                m_undoTree.activatePath(target);
+                restoreHistoryEntry(target);
+            });
+        }
+
+        // Zeilenoperationen auf der Auswahl oder dem ganzen Text
+        QMenu *linesMenu = menu->addMenu(Translations::get("lines"));
+        linesMenu->setEnabled(!m_textEdit->isReadOnly());
+        connect(linesMenu->addAction(Translations::get("sort_lines")), &QAction::triggered, this, [this]() {
+            applyLineOperation([](const QString& text) { return LineOperations::sortLines(text); });
+        });
+        connect(linesMenu->addAction(Translations::get("unique_lines")), &QAction::triggered, this, [this]() {
+            applyLineOperation([](const QString& text) { return LineOperations::uniqueLines(text); });
+        });
+        connect(linesMenu->addAction(Translations::get("filter_lines")), &QAction::triggered, this, &Editor::filterLines);
+        connect(linesMenu->addAction(Translations::get("reverse_lines")), &QAction::triggered, this, [this]() {
+            applyLineOperation([](const QString& text) { return LineOperations::reverseLines(text); });
+        });
+
         menu->addSeparator();
         
         // Direkt ins Hauptmenü
@@ -536,7 +1055,20 @@ void Editor::loadSettings()
     m_toggleWindowShortcut = QKeySequence(settings.value("toggleWindowShortcut").toString());
     m_language = settings.value("language", "en").toString();
     m_fontSize = settings.value("fontSize", 11).toInt();  // Standardwert 11
+    m_hibernateMinutes = settings.value("hibernateMinutes", 10).toInt();  // 0 = nie
+    m_retentionEnabled = settings.value("retentionEnabled", true).toBool();
+    m_retentionKeepAllMinutes = settings.value("retentionKeepAllMinutes", 60).toInt();
+    m_retentionPerMinuteHours = settings.value("retentionPerMinuteHours", 24).toInt();
+    m_retention.configure(m_retentionEnabled, m_retentionKeepAllMinutes, m_retentionPerMinuteHours);
+    m_wordCompletion = settings.value("wordCompletion", true).toBool();
+    m_completionFromHistory = settings.value("completionFromHistory", false).toBool();
+    m_showStatusBar = settings.value("statusBar", true).toBool();
+    statusBar()->setVisible(m_showStatusBar);
+    m_mirrorEnabled = settings.value("mirrorFile", false).toBool();
+    m_mirrorPath = settings.value("mirrorPath", getDataDir() + "/current.txt").toString();
+    m_mirror->setPath(m_mirrorEnabled ? m_mirrorPath : QString());
     Translations::setLanguage(m_language);
+    m_keyBindings->load(settings);
     
     applyColors();
     QRect geometry = settings.value("windowGeometry", QRect(100, 100, 800, 600)).toRect();
@@ -555,6 +1087,16 @@ void Editor::saveSettings()
     settings.setValue("toggleWindowShortcut", m_toggleWindowShortcut.toString());
     settings.setValue("language", m_language);
     settings.setValue("fontSize", m_fontSize);  // Schriftgröße speichern
+    settings.setValue("hibernateMinutes", m_hibernateMinutes);
+    settings.setValue("retentionEnabled", m_retentionEnabled);
+    settings.setValue("retentionKeepAllMinutes", m_retentionKeepAllMinutes);
+    settings.setValue("retentionPerMinuteHours", m_retentionPerMinuteHours);
+    settings.setValue("wordCompletion", m_wordCompletion);
+    settings.setValue("completionFromHistory", m_completionFromHistory);
+    settings.setValue("statusBar", m_showStatusBar);
+    settings.setValue("mirrorFile", m_mirrorEnabled);
+    settings.setValue("mirrorPath", m_mirrorPath);
+    m_keyBindings->save(settings);
     settings.setValue("windowGeometry", geometry());
 }
 
@@ -564,12 +1106,50 @@ void Editor::applyColors()
     p.setColor(QPalette::Base, m_backgroundColor);
     p.setColor(QPalette::Text, m_textColor);
     m_textEdit->setPalette(p);
+    m_textEdit->setCurrentCharFormat(textFormat());
+}
 
+/**
+ * @brief Standardformat für den gesamten Text
+ */
+QTextCharFormat Editor::textFormat() const
+{
     QTextCharFormat format;
     format.setForeground(m_textColor);
     format.setBackground(m_backgroundColor);
     format.setFontPointSize(m_fontSize);  // Verwende die gespeicherte Schriftgröße
-    m_textEdit->setCurrentCharFormat(format);
+    return format;
+}
+
+/**
+ * @brief Fügt großen Text stückweise mit Fortschrittsanzeige ein
+ *
+ * Während des Einfügens wird weder formatiert noch die History geschrieben.
+ * Am Ende entsteht ein einziger History-Eintrag, der im Hintergrund
+ * komprimiert wird.
+ */
+void Editor::pasteLargeText(const QString& text)
+{
+    commitScrubVersion(m_scrubIndex);
+
+    QProgressDialog *progress = new QProgressDialog(Translations::get("pasting"), Translations::get("cancel"), 0, text.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+
+    LargePaste *paste = new LargePaste(m_textEdit, text, textFormat(), this);
+    connect(paste, &LargePaste::progress, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, paste, &LargePaste::cancel);
+    connect(paste, &LargePaste::finished, this, [this, paste, progress](bool completed) {
+        progress->deleteLater();
+        paste->deleteLater();
+        m_deactivateHistoryEvent = false;
+        if (completed) {
+            saveHistory(true);
+        }
+    });
+
+    m_deactivateHistoryEvent = true;
+    paste->start();
 }
 
 void Editor::closeEvent(QCloseEvent *event)
@@ -579,6 +1159,148 @@ void Editor::closeEvent(QCloseEvent *event)
     hide();
 }
 
+void Editor::showEvent(QShowEvent *event)
+{
+    if (m_hibernateTimer) m_hibernateTimer->stop();
+    if (m_hibernated) {
+        wakeUp();
+        m_textEdit->document()->pageCount();  // Layout abschließen, sonst wird die Bildlaufposition begrenzt
+    }
+    if (m_scrollPosition.x() >= 0) {
+        m_textEdit->horizontalScrollBar()->setValue(m_scrollPosition.x());
+        m_textEdit->verticalScrollBar()->setValue(m_scrollPosition.y());
+    }
+    QMainWindow::showEvent(event);
+}
+
+void Editor::hideEvent(QHideEvent *event)
+{
+    if (m_textEdit) {
+        m_scrollPosition = QPoint(m_textEdit->horizontalScrollBar()->value(), m_textEdit->verticalScrollBar()->value());
+    }
+    QMainWindow::hideEvent(event);
+    startHibernateTimer();
+    QTimer::singleShot(0, this, &Editor::prewarm);
+}
+
+/**
+ * @brief Blendet das Fenster ein oder aus (Hotkey und Nachricht "toggle")
+ */
+void Editor::toggleWindow()
+{
+    if (isVisible()) {
+        hide();
+    } else {
+        presentWindow();
+    }
+}
+
+/**
+ * @brief Zeigt das Fenster an und misst die Zeit bis zum ersten Zeichnen
+ */
+void Editor::presentWindow()
+{
+    m_showTimer.start();
+    show();
+    raise();
+    activateWindow();
+}
+
+/**
+ * @brief Bereitet das versteckte Fenster so vor, dass show() nur noch zeichnen muss
+ *
+ * Das native Fenster bleibt erhalten und das Dokument wird vollständig
+ * layoutet, solange nichts anderes zu tun ist. Da sich die Größe beim
+ * Verstecken nicht ändert, löst das Einblenden kein neues Layout aus.
+ * Nach dem Ruhezustand muss das Dokument dagegen neu aufgebaut werden.
+ */
+void Editor::prewarm()
+{
+    if (!m_textEdit || isVisible() || m_hibernated) return;
+    winId();
+    ensurePolished();
+    centralWidget()->layout()->activate();
+    m_textEdit->document()->pageCount();  // Erzwingt das vollständige Layout des Dokuments
+}
+
+bool Editor::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && obj == m_textEdit->viewport() && m_showTimer.isValid()) {
+        m_showToPaintMs = m_showTimer.nsecsElapsed() / 1e6;  // Abfrage über "stats"
+        m_showTimer.invalidate();
+    }
+    return QMainWindow::eventFilter(obj, event);
+}
+
+void Editor::startHibernateTimer()
+{
+    if (!m_hibernateTimer) return;
+    if (m_hibernateMinutes > 0 && !m_hibernated && !isVisible()) {
+        m_hibernateTimer->start(m_hibernateMinutes * 60 * 1000);
+    } else {
+        m_hibernateTimer->stop();
+    }
+}
+
+/**
+ * @brief Gibt Speicher frei, solange das Fenster versteckt ist
+ *
+ * Der Text steht vollständig in der History auf der Festplatte. Das Dokument
+ * samt Layout wird geleert, dekodierte History-Blöcke werden verworfen und
+ * freier Heap an das System zurückgegeben. Für das Aufwachen genügt der
+ * aktuelle Index, der zugehörige Block wird dann einzeln gelesen.
+ */
+void Editor::hibernate()
+{
+    if (m_hibernated || !m_historyReady || isVisible()) return;
+    if (m_textEdit->isReadOnly()) {
+        startHibernateTimer();  // Großes Einfügen läuft noch, später erneut versuchen
+        return;
+    }
+    const qint64 rssBefore = ProcessMemory::residentSetSize();
+
+    commitScrubVersion(m_scrubIndex);
+    m_store.setCurrentIndex(m_currentHistoryIndex);
+    if (!m_store.save()) {
+        qDebug() << "Ruhezustand abgebrochen, History konnte nicht gespeichert werden";
+        return;
+    }
+    m_store.releaseCache();
+    m_completer->setHistoryVocabulary(nullptr);
+
+    const bool blocked = m_textEdit->blockSignals(true);
+    m_textEdit->document()->clear();
+    m_textEdit->blockSignals(blocked);
+    m_hibernated = true;
+
+    ProcessMemory::releaseFreeMemory();
+    const qint64 rssAfter = ProcessMemory::residentSetSize();
+    qDebug() << "Ruhezustand: RSS vorher" << rssBefore / 1024 << "kB, nachher" << rssAfter / 1024 << "kB";
+}
+
+/**
+ * @brief Stellt Text und Cursor nach dem Ruhezustand wieder her
+ */
+void Editor::wakeUp()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_hibernated = false;
+
+    if (m_currentHistoryIndex >= 0 && m_currentHistoryIndex < m_store.size()) {
+        const QJsonObject state = m_store.entry(m_currentHistoryIndex);
+        m_deactivateHistoryEvent = true;
+        m_textEdit->setText(state["text"].toString());
+        QTextCursor cursor = m_textEdit->textCursor();
+        cursor.setPosition(state["cursor"].toInt());
+        m_textEdit->setTextCursor(cursor);
+        m_deactivateHistoryEvent = false;
+    }
+    loadCompletionVocabulary();
+    startHibernateTimer();  // Bei verstecktem Fenster erneut einschlafen
+    qDebug() << "Aufgewacht in" << timer.elapsed() << "ms";
+}
+
 void Editor::setupGlobalShortcut()
 {
     if (m_toggleHotkey) {
@@ -620,15 +1342,7 @@ void Editor::setupGlobalShortcut()
     const bool canUseGlobalHotkey = QX11Info::isPlatformX11();
 #endif
 
-    const auto onToggle = [this]() {
-        if (isVisible()) {
-            hide();
-        } else {
-            show();
-            raise();
-            activateWindow();
-        }
-    };
+    const auto onToggle = [this]() { toggleWindow(); };
 
     if (canUseGlobalHotkey) {
         // #region agent log
@@ -661,19 +1375,13 @@ void Editor::setupGlobalShortcut()
 
 void Editor::saveHistoryIndex()
 {
-    m_state["currentIndex"] = m_currentHistoryIndex;
-    
-    QFile file(getHistoryFile());
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonObject saveData;
-        saveData["history"] = m_history;
-        saveData["state"] = m_state;
-        
-        QJsonDocument doc(saveData);
-        QByteArray data = doc.toJson();
-        QByteArray compressedData = compressData(data);
-        file.write(compressedData);
-        file.close();
+    // Schreibt nur den Index mit dem Zustand neu
+    m_store.setCurrentIndex(m_currentHistoryIndex);
+    m_store.save();
+    saveCurrentState(m_textEdit->toPlainText(), m_textEdit->textCursor().position());
+
+    if (m_timeline->isVisible()) {
+        m_timeline->setRange(m_store.size(), m_currentHistoryIndex);
     }
 }
 
@@ -686,11 +1394,7 @@ void Editor::setupTrayIcon()
     
     // QuickNote-Button zum Einblenden
     QAction* showAction = trayMenu->addAction("QuickNote");
-    connect(showAction, &QAction::triggered, this, [this]() {
-        show();
-        raise();
-        activateWindow();
-    });
+    connect(showAction, &QAction::triggered, this, &Editor::presentWindow);
     
     trayMenu->addSeparator();
     
@@ -792,6 +1496,61 @@ void Editor::setupSettingsMenu(QMenu* settingsMenu)
         historyLayout->addWidget(historyLabel);
         historyLayout->addWidget(historySpin);
         layout->addLayout(historyLayout);
+
+        // Ruhezustand im Hintergrund
+        QHBoxLayout *hibernateLayout = new QHBoxLayout();
+        QLabel *hibernateLabel = new QLabel(Translations::get("hibernate_after") + ":", &dialog);
+        QSpinBox *hibernateSpin = new QSpinBox(&dialog);
+        hibernateSpin->setRange(0, 1440);
+        hibernateSpin->setSpecialValueText(Translations::get("never"));
+        hibernateSpin->setSuffix(" min");
+        hibernateSpin->setValue(m_hibernateMinutes);
+        hibernateLayout->addWidget(hibernateLabel);
+        hibernateLayout->addWidget(hibernateSpin);
+        layout->addLayout(hibernateLayout);
+
+        // Alte Versionen ausdünnen
+        QGroupBox *retentionGroup = new QGroupBox(Translations::get("retention"), &dialog);
+        retentionGroup->setCheckable(true);
+        retentionGroup->setChecked(m_retentionEnabled);
+        QVBoxLayout *retentionLayout = new QVBoxLayout(retentionGroup);
+        QHBoxLayout *keepAllLayout = new QHBoxLayout();
+        QSpinBox *keepAllSpin = new QSpinBox(&dialog);
+        keepAllSpin->setRange(1, 10080);
+        keepAllSpin->setSuffix(" min");
+        keepAllSpin->setValue(m_retentionKeepAllMinutes);
+        keepAllLayout->addWidget(new QLabel(Translations::get("retention_keep_all") + ":", &dialog));
+        keepAllLayout->addWidget(keepAllSpin);
+        retentionLayout->addLayout(keepAllLayout);
+        QHBoxLayout *perMinuteLayout = new QHBoxLayout();
+        QSpinBox *perMinuteSpin = new QSpinBox(&dialog);
+        perMinuteSpin->setRange(0, 8760);
+        perMinuteSpin->setSuffix(" h");
+        perMinuteSpin->setValue(m_retentionPerMinuteHours);
+        perMinuteLayout->addWidget(new QLabel(Translations::get("retention_per_minute") + ":", &dialog));
+        perMinuteLayout->addWidget(perMinuteSpin);
+        retentionLayout->addLayout(perMinuteLayout);
+        retentionLayout->addWidget(new QLabel(Translations::get("retention_per_hour"), &dialog));
+        layout->addWidget(retentionGroup);
+
+        // Wortvervollständigung
+        QGroupBox *completionGroup = new QGroupBox(Translations::get("word_completion"), &dialog);
+        completionGroup->setCheckable(true);
+        completionGroup->setChecked(m_wordCompletion);
+        QVBoxLayout *completionLayout = new QVBoxLayout(completionGroup);
+        QCheckBox *completionHistoryCheck = new QCheckBox(Translations::get("completion_from_history"), &dialog);
+        completionHistoryCheck->setChecked(m_completionFromHistory);
+        completionLayout->addWidget(completionHistoryCheck);
+        layout->addWidget(completionGroup);
+
+        QCheckBox *statusBarCheck = new QCheckBox(Translations::get("show_status_bar"), &dialog);
+        statusBarCheck->setChecked(m_showStatusBar);
+        layout->addWidget(statusBarCheck);
+
+        QCheckBox *mirrorCheck = new QCheckBox(Translations::get("mirror_file"), &dialog);
+        mirrorCheck->setToolTip(m_mirrorPath);
+        mirrorCheck->setChecked(m_mirrorEnabled);
+        layout->addWidget(mirrorCheck);
         
         // Sprachauswahl
         QHBoxLayout *langLayout = new QHBoxLayout();
@@ -838,9 +1597,31 @@ void Editor::setupSettingsMenu(QMenu* settingsMenu)
         connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
         if (dialog.exec() == QDialog::Accepted) {
+            if (m_hibernated) wakeUp();  // Das Dokument wird unten neu formatiert und gespeichert
             m_maxHistorySize = historySpin->value();
             m_toggleWindowShortcut = shortcutEdit->keySequence();
             m_fontSize = fontSizeSpin->value();
+            m_hibernateMinutes = hibernateSpin->value();
+            startHibernateTimer();
+            m_retentionEnabled = retentionGroup->isChecked();
+            m_retentionKeepAllMinutes = keepAllSpin->value();
+            m_retentionPerMinuteHours = perMinuteSpin->value();
+            m_retention.configure(m_retentionEnabled, m_retentionKeepAllMinutes, m_retentionPerMinuteHours);
+            m_wordCompletion = completionGroup->isChecked();
+            m_completionFromHistory = completionHistoryCheck->isChecked();
+            if (m_historyReady) {
+                m_completer->setEnabled(m_wordCompletion);
+                m_completer->setHistoryVocabulary(nullptr);
+                loadCompletionVocabulary();
+            }
+            m_showStatusBar = statusBarCheck->isChecked();
+            statusBar()->setVisible(m_showStatusBar);
+            updateStatusBar();
+            if (mirrorCheck->isChecked() != m_mirrorEnabled) {
+                m_mirrorEnabled = mirrorCheck->isChecked();
+                m_mirror->setPath(m_mirrorEnabled ? m_mirrorPath : QString());
+                if (m_mirrorEnabled) m_mirror->update(m_textEdit->toPlainText());
+            }
             applyColors();
             saveSettings();
             setupGlobalShortcut();
@@ -856,7 +1637,9 @@ void Editor::setupSettingsMenu(QMenu* settingsMenu)
                 setupTrayIcon();
             }
 
-            // Rufe onTextChanged auf, um die Formatierung zu aktualisieren
+            // Rufe onTextChanged auf, um die Formatierung des ganzen Texts zu aktualisieren
+            m_formatFrom = 0;
+            m_formatTo = m_textEdit->document()->characterCount();
             onTextChanged();
         }
     });
@@ -866,14 +1649,20 @@ void Editor::setupSettingsMenu(QMenu* settingsMenu)
     // History löschen als separater Menüpunkt
     QAction *clearHistoryAction = settingsMenu->addAction(Translations::get("clear_history"));
     connect(clearHistoryAction, &QAction::triggered, this, [this]() {
+        if (!m_historyReady) return;  // Würde vom Laden im Hintergrund überschrieben
+        if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
         QMessageBox::StandardButton reply = QMessageBox::question(this, 
             Translations::get("clear_history"),
             Translations::get("clear_history_confirm"),
             QMessageBox::Yes | QMessageBox::No);
         
         if (reply == QMessageBox::Yes) {
-            m_history = QJsonArray();
+            if (m_hibernated) wakeUp();  // Danach ist der Text nur noch im Dokument
+            m_store.clear();
+            m_undoTree.clear();
+            m_retention.reset();
             m_currentHistoryIndex = -1;
+            m_fingerprintId = -1;   // Kennungen beginnen wieder bei 0
             saveHistory();
         }
     });
@@ -883,7 +1672,8 @@ void Editor::setupSingleInstance()
 {
      // Prüfe auf andere Instanz und sende "toggle"
      QLocalSocket socket;
-     socket.connectToServer(SERVER_NAME);
+     const QString serverName = getServerName();
+     socket.connectToServer(serverName);
      
      if (socket.waitForConnected(500)) {
          socket.write("toggle");
@@ -897,46 +1687,84 @@ void Editor::setupSingleInstance()
      
      // Erstelle Server für diese Instanz
      m_localServer = new QLocalServer(this);
-     QLocalServer::removeServer(SERVER_NAME);
-     if (!m_localServer->listen(SERVER_NAME)) {
+     QLocalServer::removeServer(serverName);
+     if (!m_localServer->listen(serverName)) {
          qDebug() << "Server konnte nicht gestartet werden";
          return;
      }
      
-     // Eingehende Verbindungen verarbeiten
+     // Lesende Abfragen laufen auf einer Kopie der History in einem eigenen Thread
+     m_queryServer = new QueryServer([this]() {
+         QueryServer::Snapshot snapshot;
+         // Im Ruhezustand ist das Dokument leer, der Text steht in der History
+         snapshot.currentText = m_hibernated ? m_store.entry(m_currentHistoryIndex)["text"].toString()
+                                             : m_textEdit->toPlainText();
+         snapshot.historyReady = m_historyReady;
+         snapshot.stats["versions"] = m_store.size();
+         snapshot.stats["blocks"] = m_store.blockCount();
+         snapshot.stats["shards"] = m_store.shardCount();
+         snapshot.stats["file_size"] = double(m_store.fileSize());
+         snapshot.stats["history_ready"] = m_historyReady;
+         snapshot.stats["show_to_paint_ms"] = m_showToPaintMs;
+         snapshot.stats["text_length"] = int(snapshot.currentText.size());
+         snapshot.stats["resident_bytes"] = double(ProcessMemory::residentSetSize());
+         snapshot.stats["keystroke_allocations"] = AllocStats::keystrokeSummary();
+         if (m_historyReady) {
+             snapshot.store = m_store.snapshot();
+             snapshot.currentIndex = m_currentHistoryIndex;
+         }
+         return snapshot;
+     }, this);
+
+     // Eingehende Verbindungen verarbeiten: "toggle" ohne Zeilenumbruch, Abfragen als Zeile
      connect(m_localServer, &QLocalServer::newConnection, this, [this]() {
          QLocalSocket *client = m_localServer->nextPendingConnection();
-         connect(client, &QLocalSocket::readyRead, this, [this, client]() {
-             QByteArray msg = client->readAll();
+         auto buffer = std::make_shared<QByteArray>();
+         connect(client, &QLocalSocket::readyRead, this, [this, client, buffer]() {
+             buffer->append(client->readAll());
+             const qsizetype newline = buffer->indexOf('\n');
+             if (newline < 0 && *buffer != "toggle") return;  // Zeile noch unvollständig
+
+             QObject::disconnect(client, nullptr, this, nullptr);
+             const QByteArray msg = buffer->left(newline < 0 ? buffer->size() : newline).trimmed();
+             if (msg != "toggle") {
+                 m_queryServer->answer(client, msg);
+                 return;
+             }
              client->close();
              client->deleteLater();
- 
-             if (msg == "toggle") {
-                 if (isVisible()) {
-                     hide();
-                 } else {
-                     show();
-                     raise();
-                     activateWindow();
-                 }
-             } else {
+             toggleWindow();
+         });
+         connect(client, &QLocalSocket::disconnected, this, [this, client, buffer]() {
+             client->deleteLater();
+             if (!buffer->isEmpty()) {
                  // Fallback: immer anzeigen (altes Verhalten)
-                 show();
-                 raise();
-                 activateWindow();
+                 presentWindow();
              }
          });
      });
 }
 
 // Hilfsfunktion zum Kopieren des ausgewählten Textes in die Zwischenablage
+/**
+ * @brief Legt die Auswahl als reinen Text in die Zwischenablage, erzeugt wird er erst beim Einfügen
+ *
+ * Entspricht das Dokument der angezeigten Version, genügt ein Verweis auf
+ * deren History-Eintrag, der Text wird dann gar nicht kopiert.
+ */
 void Editor::copySelectedTextToClipboard()
 {
-    QClipboard *clipboard = QApplication::clipboard();
-    clipboard->clear();  // Leere die Zwischenablage
-
-    QString plainText = m_textEdit->textCursor().selectedText();
-    clipboard->setText(plainText, QClipboard::Clipboard);  // Füge den reinen Text hinzu
+    const QTextCursor cursor = m_textEdit->textCursor();
+    const int version = m_scrubIndex >= 0 ? m_scrubIndex : m_currentHistoryIndex;
+    ClipboardText *data = nullptr;
+    if (m_historyReady && version >= 0 && version < m_store.size()
+        && entryFingerprint(version) == m_lineIndex.fingerprint()) {
+        data = new ClipboardText(m_store.entry(version), cursor.selectionStart(),
+                                 cursor.selectionEnd() - cursor.selectionStart());
+    } else {
+        data = new ClipboardText(cursor.selectedText());
+    }
+    QApplication::clipboard()->setMimeData(data, QClipboard::Clipboard);
 }
 
 void Editor::onCopy()
@@ -947,6 +1775,7 @@ void Editor::onCopy()
 
 void Editor::onCut()
 {
+    if (m_textEdit->isReadOnly()) return;  // Großes Einfügen läuft noch
     qDebug() << "onCut called";
     copySelectedTextToClipboard();
 
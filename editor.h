@@ -11,6 +11,7 @@
 #include <QMessageBox>
 #include <QAction>
 #include <QTextCursor>
+#include <QTextCharFormat>
 #include <QKeyEvent>
 #include <zlib.h>
 #include <QJsonObject>
@@ -27,6 +28,22 @@
 #include "qhotkey.h"
 #include <QtNetwork/QLocalServer>
 #include <QSystemTrayIcon>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPoint>
+#include "historystore.h"
+#include "undotree.h"
+#include "retention.h"
+#include "timelinebar.h"
+#include "findbar.h"
+#include "wordcompleter.h"
+#include "lineindex.h"
+#include "mirrorfile.h"
+#include "statefile.h"
+#include "queryserver.h"
+#include "keybindings.h"
+#include "notetextedit.h"
+#include <functional>
 
 class Editor : public QMainWindow
 {
@@ -44,36 +61,81 @@ public:
      */
     ~Editor();
 
-protected:
     /**
-     * @brief Filtert Events für Tastenkombinationen
-     * @param obj Das Objekt, das das Event empfängt
-     * @param event Das zu verarbeitende Event
-     * @return true wenn Event verarbeitet wurde, sonst false
+     * @brief Gibt beim Start die Dauer der einzelnen Schritte aus (--profile-startup)
      */
-    bool eventFilter(QObject *obj, QEvent *event) override;
+    static void setStartupProfiling(bool enabled);
+
+    /**
+     * @brief true sobald die History im Hintergrund geladen ist
+     */
+    bool isHistoryReady() const { return m_historyReady; }
 
+    /**
+     * @brief Name des lokalen Servers der laufenden Instanz
+     */
+    static QString getServerName();
+
+signals:
+    void historyReady();
+
+protected:
     void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    bool eventFilter(QObject *obj, QEvent *event) override;
 
 private:
     static const QString SERVER_NAME;  // Konstante für den Servernamen
     // attributes
-    QTextEdit* m_textEdit;
-    QJsonArray m_history;
+    NoteTextEdit* m_textEdit;
+    HistoryStore m_store;
+    UndoTree m_undoTree;
+    RetentionPolicy m_retention;
+    bool m_retentionEnabled;
+    int m_retentionKeepAllMinutes;
+    int m_retentionPerMinuteHours;
+    TimelineBar* m_timeline;
+    FindBar* m_findBar;
+    WordCompleter* m_completer;
+    bool m_wordCompletion;
+    bool m_completionFromHistory;   // Wörter älterer Versionen zusätzlich vorschlagen
+    LineIndex m_lineIndex;
+    QLabel* m_statusLabel;
+    bool m_showStatusBar;
+    MirrorFile* m_mirror;       // Textkopie der Notiz für andere Programme
+    bool m_mirrorEnabled;
+    QString m_mirrorPath;
+    StateFile* m_stateFile;     // Text und Cursor für den schnellen Start
+    qint64 m_fingerprintId;     // Kennung des Eintrags, zu dem m_fingerprint gehört, sonst -1
+    quint64 m_fingerprint;
+    KeyBindings* m_keyBindings;
+    int m_scrubIndex;           // In der Zeitleiste angezeigt, aber nicht übernommen, sonst -1
     int m_currentHistoryIndex;
     bool m_deactivateHistoryEvent;
     bool m_dontSaveSettings;
     int m_maxHistorySize;
-    QJsonObject m_state;
     QColor m_backgroundColor;
     QColor m_textColor;
     QKeySequence m_toggleWindowShortcut;
     QHotkey* m_toggleHotkey;
     QShortcut* m_toggleShortcutFallback;
     QLocalServer* m_localServer;
+    QueryServer* m_queryServer;
     QSystemTrayIcon* m_trayIcon;
     QString m_language; 
     int m_fontSize;  
+    int m_hibernateMinutes;     // Ruhezustand nach so vielen Minuten versteckt, 0 = nie
+    QTimer* m_hibernateTimer;
+    bool m_hibernated;
+    bool m_historyReady;        // History geladen, vorher kein Undo und keine neuen Einträge
+    bool m_stateLoaded;         // Text kam beim Start aus der Zustandsdatei
+    QPoint m_scrollPosition;    // Bildlaufposition beim Verstecken
+    QElapsedTimer m_showTimer;  // Läuft vom Einblenden bis zum ersten Zeichnen
+    double m_showToPaintMs;     // Zuletzt gemessene Dauer bis zum ersten Zeichnen, -1 = noch keine
+    QString m_lastFilterPattern;
+    int m_formatFrom;           // Seit dem letzten Formatieren geänderter Bereich, -1 = keiner
+    int m_formatTo;
 
     // methods
     /**
@@ -82,6 +144,18 @@ private:
      */
     QString getHistoryFile() const;
 
+    /**
+     * @brief Gibt den Pfad zur Datei mit aktuellem Text und Cursor zurück
+     */
+    QString getCurrentStateFile() const;
+
+    /**
+     * @brief Zeigt Text und Cursor aus der Zustandsdatei an
+     * @return false wenn die Datei fehlt oder unvollständig ist
+     */
+    bool loadCurrentState();
+    void saveCurrentState(const QString& text, int cursorPos);
+
     /**
      * @brief Richtet die Tastenkombinationen ein
      */
@@ -90,12 +164,61 @@ private:
     /**
      * @brief Speichert den Verlauf in eine JSON-Datei
      */
-    void saveHistory();
+    void saveHistory(bool inBackground = false);
+
+    quint64 entryFingerprint(int index);
+
+    void applyRetention();
 
     /**
-     * @brief Lädt den Verlauf aus der JSON-Datei
+     * @brief Lädt den Verlauf im Thread-Pool, danach folgt finishHistoryLoad()
      */
     void loadHistory();
+    void finishHistoryLoad(HistoryStore& store, UndoTree& tree, bool ok);
+
+    /**
+     * @brief Zeigt einen Eintrag der History an, ohne einen neuen anzulegen
+     */
+    void restoreHistoryEntry(int index);
+
+    void toggleTimeline();
+    void restoreToTime();
+    void showScrubVersion(int index);
+    void commitScrubVersion(int index);
+
+    /**
+     * @brief Ersetzt den Text, ändert aber nur den Bereich zwischen gemeinsamem Anfang und Ende
+     */
+    void replaceTextMinimal(const QString& text);
+
+    QTextCharFormat textFormat() const;
+    void pasteLargeText(const QString& text);
+
+    void replaceAll(const QString& text);
+
+    void updateCompletion();
+
+    /**
+     * @brief Zeigt Zeile, Spalte, Zeichenzahl und Version in der Statusleiste
+     */
+    void updateStatusBar();
+    void goToLine();
+
+    /**
+     * @brief Baut im Hintergrund den Wortschatz älterer Versionen auf
+     */
+    void loadCompletionVocabulary();
+
+    void applyLineOperation(const std::function<QString(const QString&)>& operation);
+    void filterLines();
+
+    void toggleWindow();
+    void presentWindow();
+    void prewarm();
+
+    void startHibernateTimer();
+    void hibernate();
+    void wakeUp();
 
     /**
      * @brief Führt eine Redo-Operation aus
@@ -139,6 +262,7 @@ private slots:
      * @brief Wird aufgerufen, wenn sich der Text ändert
      */
     void onTextChanged();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
 
     /**
      * @brief Wird aufgerufen, wenn Text kopiert wird
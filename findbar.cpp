@@ -0,0 +1,324 @@
+#include "findbar.h"
+#include "textsearch.h"
+#include "translations.h"
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QKeyEvent>
+#include <QTextDocument>
+#include <algorithm>
+
+FindBar::FindBar(QTextEdit *target, QWidget *parent)
+    : QWidget(parent), m_target(target), m_textValid(false), m_cs(Qt::CaseInsensitive), m_current(-1)
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(6, 2, 6, 2);
+
+    m_findEdit = new QLineEdit(this);
+    m_findEdit->setPlaceholderText(Translations::get("find"));
+    m_replaceEdit = new QLineEdit(this);
+    m_replaceEdit->setPlaceholderText(Translations::get("replace"));
+    m_caseCheck = new QCheckBox(Translations::get("match_case"), this);
+    m_countLabel = new QLabel(this);
+    QPushButton *previousButton = new QPushButton("<", this);
+    QPushButton *nextButton = new QPushButton(">", this);
+    QPushButton *replaceButton = new QPushButton(Translations::get("replace"), this);
+    QPushButton *replaceAllButton = new QPushButton(Translations::get("replace_all"), this);
+    QPushButton *closeButton = new QPushButton("×", this);
+    for (QPushButton *button : {previousButton, nextButton, closeButton}) {
+        button->setFixedWidth(button->fontMetrics().horizontalAdvance("MM"));
+    }
+
+    layout->addWidget(m_findEdit, 2);
+    layout->addWidget(previousButton);
+    layout->addWidget(nextButton);
+    layout->addWidget(m_countLabel);
+    layout->addWidget(m_caseCheck);
+    layout->addWidget(m_replaceEdit, 1);
+    layout->addWidget(replaceButton);
+    layout->addWidget(replaceAllButton);
+    layout->addWidget(closeButton);
+
+    m_findEdit->installEventFilter(this);
+    m_replaceEdit->installEventFilter(this);
+
+    connect(m_findEdit, &QLineEdit::textChanged, this, &FindBar::search);
+    connect(m_caseCheck, &QCheckBox::toggled, this, &FindBar::search);
+    connect(previousButton, &QPushButton::clicked, this, [this]() { findNext(true); });
+    connect(nextButton, &QPushButton::clicked, this, [this]() { findNext(false); });
+    connect(replaceButton, &QPushButton::clicked, this, &FindBar::replaceCurrent);
+    connect(replaceAllButton, &QPushButton::clicked, this, &FindBar::replaceAll);
+    connect(closeButton, &QPushButton::clicked, this, &FindBar::deactivate);
+
+    connect(m_target->document(), &QTextDocument::contentsChange, this, &FindBar::onContentsChange);
+
+    // Hervorhebungen nur für den sichtbaren Ausschnitt, nach dem Rollen neu
+    m_highlightTimer.setSingleShot(true);
+    m_highlightTimer.setInterval(0);
+    connect(&m_highlightTimer, &QTimer::timeout, this, &FindBar::updateHighlights);
+    connect(m_target->verticalScrollBar(), &QScrollBar::valueChanged, &m_highlightTimer, qOverload<>(&QTimer::start));
+    connect(m_target->horizontalScrollBar(), &QScrollBar::valueChanged, &m_highlightTimer, qOverload<>(&QTimer::start));
+
+    updateCountLabel();
+}
+
+void FindBar::activate()
+{
+    const QString selected = m_target->textCursor().selectedText();
+    if (!selected.isEmpty() && !selected.contains(QChar::ParagraphSeparator)) {
+        m_findEdit->setText(selected);
+    }
+    show();
+    ensureText();
+    search();
+    m_findEdit->setFocus();
+    m_findEdit->selectAll();
+}
+
+void FindBar::deactivate()
+{
+    hide();
+    m_target->setExtraSelections({});
+    m_text.clear();
+    m_textValid = false;
+    m_matches.clear();
+    m_query.clear();
+    m_current = -1;
+    emit closed();
+}
+
+bool FindBar::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::KeyPress) {
+        const QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Escape) {
+            deactivate();
+            return true;
+        }
+        if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter) {
+            if (obj == m_replaceEdit) {
+                replaceCurrent();
+            } else {
+                findNext(keyEvent->modifiers() & Qt::ShiftModifier);
+            }
+            return true;
+        }
+    }
+    return QWidget::eventFilter(obj, event);
+}
+
+void FindBar::ensureText()
+{
+    if (m_textValid) return;
+    m_text = m_target->toPlainText();
+    m_textValid = true;
+    m_query.clear();  // Fundstellen passen nicht mehr zum Text
+}
+
+/**
+ * @brief Sucht nach dem aktuellen Begriff
+ *
+ * Verlängert der neue Begriff den bisherigen, können nur bisherige
+ * Fundstellen passen; sie werden einzeln geprüft statt neu zu suchen.
+ */
+void FindBar::search()
+{
+    if (!isVisible()) return;
+    ensureText();
+    const QString query = m_findEdit->text();
+    const Qt::CaseSensitivity cs = m_caseCheck->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    if (!m_query.isEmpty() && cs == m_cs && query.size() > m_query.size() && query.startsWith(m_query, cs)) {
+        QVector<qsizetype> kept;
+        for (qsizetype pos : m_matches) {
+            if (TextSearch::matchesAt(m_text, pos, query, cs)) kept.append(pos);
+        }
+        m_matches = kept;
+    } else {
+        m_matches = TextSearch::findAll(m_text, query, cs);
+    }
+    m_query = query;
+    m_cs = cs;
+
+    // Erste Fundstelle ab dem Cursor, ohne ihn zu bewegen
+    const auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), qsizetype(m_target->textCursor().selectionStart()));
+    m_current = m_matches.isEmpty() ? -1 : int(it == m_matches.cend() ? 0 : it - m_matches.cbegin());
+    updateCountLabel();
+    updateHighlights();
+}
+
+/**
+ * @brief Liest einen Abschnitt des Dokuments wie toPlainText()
+ */
+QString FindBar::plainSlice(int pos, int length) const
+{
+    if (length <= 0) return QString();
+    QTextCursor cursor(m_target->document());
+    cursor.setPosition(pos);
+    cursor.setPosition(pos + length, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    for (QChar& c : text) {
+        if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator) {
+            c = u'\n';
+        } else if (c == QChar::Nbsp) {
+            c = u' ';
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Führt Text und Fundstellen nach einer Änderung am Dokument nach
+ */
+void FindBar::onContentsChange(int pos, int removed, int added)
+{
+    if (!isVisible() || !m_textValid) {
+        m_textValid = false;
+        return;
+    }
+
+    // Änderungen am Dokumentende enthalten den abschließenden Absatz, der im Klartext fehlt
+    const qsizetype documentLength = m_target->document()->characterCount() - 1;
+    const qsizetype overflow = qsizetype(pos) + removed - m_text.size();
+    if (overflow > 0) {
+        removed -= int(overflow);
+        added -= int(overflow);
+    }
+    if (pos < 0 || removed < 0 || added < 0 || m_text.size() - removed + added != documentLength) {
+        m_textValid = false;
+        search();
+        return;
+    }
+
+    const QString inserted = plainSlice(pos, added);
+    if (removed == added && QStringView(m_text).mid(pos, removed) == inserted) {
+        return;  // Nur Formatierung geändert
+    }
+    m_text.replace(pos, removed, inserted);
+    if (m_query.isEmpty()) return;
+
+    // Fundstellen, die den geänderten Bereich berühren, neu suchen, spätere verschieben
+    const qsizetype length = m_query.size();
+    const qsizetype delta = qsizetype(added) - removed;
+    auto first = std::lower_bound(m_matches.begin(), m_matches.end(), pos - length + 1);
+    auto last = std::lower_bound(first, m_matches.end(), qsizetype(pos) + removed);
+    for (auto it = last; it != m_matches.end(); ++it) *it += delta;
+    const qsizetype at = first - m_matches.begin();
+    m_matches.erase(first, last);
+    const QVector<qsizetype> fresh = TextSearch::findAll(m_text, m_query, m_cs, pos - length + 1, qsizetype(pos) + added);
+    m_matches.insert(at, fresh.size(), 0);
+    std::copy(fresh.cbegin(), fresh.cend(), m_matches.begin() + at);
+
+    if (m_current >= m_matches.size()) m_current = m_matches.isEmpty() ? -1 : 0;
+    updateCountLabel();
+    m_highlightTimer.start();
+}
+
+void FindBar::findNext(bool backwards)
+{
+    search();
+    if (m_matches.isEmpty()) return;
+
+    const QTextCursor cursor = m_target->textCursor();
+    const qsizetype start = cursor.selectionStart();
+    int index;
+    if (backwards) {
+        const auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), start);
+        index = int(it - m_matches.cbegin()) - 1;
+        if (index < 0) index = m_matches.size() - 1;
+    } else {
+        // Eine bereits ausgewählte Fundstelle überspringen
+        const auto it = cursor.hasSelection()
+            ? std::upper_bound(m_matches.cbegin(), m_matches.cend(), start)
+            : std::lower_bound(m_matches.cbegin(), m_matches.cend(), start);
+        index = it == m_matches.cend() ? 0 : int(it - m_matches.cbegin());
+    }
+    selectMatch(index);
+}
+
+void FindBar::selectMatch(int index)
+{
+    m_current = index;
+    QTextCursor cursor(m_target->document());
+    cursor.setPosition(m_matches[index]);
+    cursor.setPosition(m_matches[index] + m_query.size(), QTextCursor::KeepAnchor);
+    m_target->setTextCursor(cursor);
+    updateCountLabel();
+    updateHighlights();
+}
+
+void FindBar::replaceCurrent()
+{
+    if (m_target->isReadOnly()) return;
+    search();
+    QTextCursor cursor = m_target->textCursor();
+    if (cursor.hasSelection() && cursor.selectionEnd() - cursor.selectionStart() == m_query.size()
+        && TextSearch::matchesAt(m_text, cursor.selectionStart(), m_query, m_cs)) {
+        cursor.insertText(m_replaceEdit->text());
+        m_target->setTextCursor(cursor);
+    }
+    findNext(false);
+}
+
+void FindBar::replaceAll()
+{
+    if (m_target->isReadOnly()) return;
+    search();
+    if (m_matches.isEmpty()) return;
+
+    // Überlappende Fundstellen werden von links nach rechts übergangen
+    const QString replacement = m_replaceEdit->text();
+    const QStringView text(m_text);
+    QString result;
+    result.reserve(m_text.size() + m_matches.size() * (replacement.size() - m_query.size()));
+    qsizetype end = 0;
+    for (qsizetype pos : m_matches) {
+        if (pos < end) continue;
+        result.append(text.mid(end, pos - end));
+        result.append(replacement);
+        end = pos + m_query.size();
+    }
+    result.append(text.mid(end));
+    emit replaceAllRequested(result);
+}
+
+void FindBar::updateHighlights()
+{
+    if (!isVisible()) return;
+
+    // Nur Fundstellen im sichtbaren Ausschnitt
+    const QWidget *viewport = m_target->viewport();
+    const qsizetype top = m_target->cursorForPosition(QPoint(0, 0)).position();
+    const qsizetype bottom = m_target->cursorForPosition(QPoint(viewport->width() - 1, viewport->height() - 1)).position();
+    auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), top - m_query.size() + 1);
+    const auto end = std::upper_bound(it, m_matches.cend(), bottom);
+
+    QTextCharFormat matchFormat;
+    matchFormat.setBackground(QColor(255, 220, 80));
+    matchFormat.setForeground(Qt::black);
+    QTextCharFormat currentFormat = matchFormat;
+    currentFormat.setBackground(QColor(255, 150, 40));
+
+    QList<QTextEdit::ExtraSelection> selections;
+    for (int n = 0; it != end && n < MAX_HIGHLIGHTS; ++it, ++n) {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(m_target->document());
+        selection.cursor.setPosition(*it);
+        selection.cursor.setPosition(*it + m_query.size(), QTextCursor::KeepAnchor);
+        const bool current = m_current >= 0 && m_current < m_matches.size() && m_matches[m_current] == *it;
+        selection.format = current ? currentFormat : matchFormat;
+        selections.append(selection);
+    }
+    m_target->setExtraSelections(selections);
+}
+
+void FindBar::updateCountLabel()
+{
+    if (m_query.isEmpty()) {
+        m_countLabel->clear();
+    } else if (m_matches.isEmpty()) {
+        m_countLabel->setText(Translations::get("no_matches"));
+    } else {
+        m_countLabel->setText(QString("%1 / %2").arg(m_current + 1).arg(m_matches.size()));
+    }
+}
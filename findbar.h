@@ -0,0 +1,79 @@
+#ifndef FINDBAR_H
+#define FINDBAR_H
+
+#include <QWidget>
+#include <QTextEdit>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QLabel>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief Suchleiste mit Hervorhebung aller Fundstellen und Ersetzen
+ *
+ * Solange die Leiste sichtbar ist, hält sie eine Kopie des Klartexts, die
+ * über QTextDocument::contentsChange nachgeführt wird. Bei Änderungen am
+ * Dokument werden nur Fundstellen um den geänderten Bereich neu gesucht,
+ * spätere werden verschoben. Wird der Suchbegriff verlängert, werden nur die
+ * bisherigen Fundstellen geprüft. Hervorgehoben wird nur der sichtbare
+ * Ausschnitt, damit auch sehr große Notizen flüssig bleiben.
+ *
+ * "Alle ersetzen" verändert das Dokument nicht selbst, sondern liefert den
+ * neuen Text mit replaceAllRequested(), damit er als ein History-Eintrag
+ * übernommen werden kann.
+ */
+class FindBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FindBar(QTextEdit *target, QWidget *parent = nullptr);
+
+    /**
+     * @brief Blendet die Leiste ein, eine einzeilige Auswahl wird Suchbegriff
+     */
+    void activate();
+
+    /**
+     * @brief Blendet die Leiste aus und entfernt die Hervorhebungen
+     */
+    void deactivate();
+
+signals:
+    void replaceAllRequested(const QString& text);
+    void closed();
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    static const int MAX_HIGHLIGHTS = 2000;     // Obergrenze je sichtbarem Ausschnitt
+
+    QTextEdit* m_target;
+    QLineEdit* m_findEdit;
+    QLineEdit* m_replaceEdit;
+    QCheckBox* m_caseCheck;
+    QLabel* m_countLabel;
+    QTimer m_highlightTimer;        // Fasst Aktualisierungen pro Durchlauf zusammen
+
+    QString m_text;                 // Klartext des Dokuments, nur gültig wenn m_textValid
+    bool m_textValid;
+    QString m_query;                // Suchbegriff der aktuellen Fundstellen
+    Qt::CaseSensitivity m_cs;
+    QVector<qsizetype> m_matches;   // Anfänge aller Fundstellen, aufsteigend
+    int m_current;                  // Ausgewählte Fundstelle oder -1
+
+    void ensureText();
+    void search();
+    void onContentsChange(int pos, int removed, int added);
+    QString plainSlice(int pos, int length) const;
+    void findNext(bool backwards);
+    void selectMatch(int index);
+    void replaceCurrent();
+    void replaceAll();
+    void updateHighlights();
+    void updateCountLabel();
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "fingerprint.h"
+
+namespace {
+
+const quint64 MODULUS = (quint64(1) << 61) - 1;
+const quint64 BASE = 0x1d2b7c3a9e4f5a1ULL % MODULUS;
+
+quint64 reduce(quint64 value)
+{
+    value = (value & MODULUS) + (value >> 61);
+    return value >= MODULUS ? value - MODULUS : value;
+}
+
+/**
+ * @brief a * b modulo 2^61-1 ohne 128-Bit-Typ, beide Faktoren kleiner als der Modulus
+ */
+quint64 mulMod(quint64 a, quint64 b)
+{
+    const quint64 aLow = a & 0xffffffffULL, aHigh = a >> 32;
+    const quint64 bLow = b & 0xffffffffULL, bHigh = b >> 32;
+    const quint64 low = aLow * bLow;
+    const quint64 middle = aLow * bHigh + aHigh * bLow;
+    const quint64 high = aHigh * bHigh;
+    // 2^64 = 8 und 2^61 = 1 modulo 2^61-1
+    const quint64 sum = (high << 3) + (middle >> 29) + ((middle & ((quint64(1) << 29) - 1)) << 32)
+        + (low >> 61) + (low & MODULUS);
+    return reduce(sum);
+}
+
+quint64 addMod(quint64 a, quint64 b)
+{
+    return reduce(a + b);
+}
+
+char16_t normalized(char16_t c)
+{
+    if (c == 0x2028 || c == 0x2029) return u'\n';
+    if (c == 0x00a0) return u' ';
+    return c;
+}
+
+} // namespace
+
+namespace Fingerprint {
+
+quint64 of(QStringView text)
+{
+    quint64 hash = 0;
+    for (QChar c : text) {
+        hash = addMod(mulMod(hash, BASE), quint64(normalized(c.unicode())) + 1);
+    }
+    return hash;
+}
+
+quint64 ofNote(QStringView text)
+{
+    return concat(of(text), quint64(u'\n') + 1, BASE);
+}
+
+quint64 power(qint64 length)
+{
+    quint64 result = 1;
+    quint64 factor = BASE;
+    while (length > 0) {
+        if (length & 1) result = mulMod(result, factor);
+        factor = mulMod(factor, factor);
+        length >>= 1;
+    }
+    return result;
+}
+
+quint64 concat(quint64 a, quint64 b, quint64 bShift)
+{
+    return addMod(mulMod(a, bShift), b);
+}
+
+QString toString(quint64 fingerprint)
+{
+    return QString::number(fingerprint, 16);
+}
+
+bool fromString(const QString& text, quint64* fingerprint)
+{
+    bool ok = false;
+    const quint64 value = text.toULongLong(&ok, 16);
+    if (ok && value < MODULUS) *fingerprint = value;
+    return ok && value < MODULUS;
+}
+
+} // namespace Fingerprint
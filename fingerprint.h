@@ -0,0 +1,53 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringView>
+
+/**
+ * @brief Polynomieller Hash über den Text einer Notiz (modulo 2^61-1)
+ *
+ * Der Hash zweier aufeinanderfolgender Teile lässt sich aus deren Hashes
+ * und der Länge des zweiten Teils zusammensetzen. Damit kann LineIndex den
+ * Hash des Dokuments aus den Hashes der Zeilen bilden und bei einer
+ * Änderung nur die berührten Zeilen neu lesen.
+ *
+ * Zeilen- und Absatztrenner (U+2028, U+2029) zählen wie '\n' und das
+ * geschützte Leerzeichen wie ' ', damit der Hash eines Absatzes zum Text
+ * aus QTextDocument::toPlainText() passt.
+ */
+namespace Fingerprint {
+
+/**
+ * @brief Hash eines Textstücks
+ */
+quint64 of(QStringView text);
+
+/**
+ * @brief Hash einer ganzen Notiz, wie ihn LineIndex::fingerprint() liefert
+ *
+ * Entspricht dem Hash des Texts mit angehängtem '\n', so wie jeder Absatz
+ * im Dokument mit einem Trennzeichen endet.
+ */
+quint64 ofNote(QStringView text);
+
+/**
+ * @brief Faktor, um den ein Hash vor einem Teil der angegebenen Länge verschoben wird
+ */
+quint64 power(qint64 length);
+
+/**
+ * @brief Hash von a gefolgt von b, bShift ist power() der Länge von b
+ */
+quint64 concat(quint64 a, quint64 b, quint64 bShift);
+
+/**
+ * @brief Darstellung für JSON, dort sind nur 53 Bit als Zahl exakt
+ */
+QString toString(quint64 fingerprint);
+bool fromString(const QString& text, quint64* fingerprint);
+
+} // namespace Fingerprint
+
+#endif
@@ -0,0 +1,409 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <cstdio>
+#include <vector>
+#include "historystore.h"
+#include "undotree.h"
+#include "crc32c.h"
+#include "diffengine.h"
+
+/*
+ * Kommandozeilenwerkzeug zum Untersuchen und Pflegen der History ohne GUI.
+ * Verwendet denselben HistoryStore wie der Editor und benötigt nur QtCore
+ * und zlib. Größere Dateien werden blockweise verarbeitet, damit der
+ * Speicherbedarf begrenzt bleibt.
+ */
+
+namespace {
+
+QString defaultHistoryFile()
+{
+    return QDir::homePath() + "/.local/share/quicknote/history.gz";
+}
+
+// Obergrenze für den naiven Vergleich, darüber dauert er Minuten
+const double NAIVE_DIFF_CELLS = 4e9;
+
+int fail(const QString& message)
+{
+    QTextStream(stderr) << "quicknote-history: " << message << Qt::endl;
+    return 1;
+}
+
+bool openStore(HistoryStore& store, const QString& path, QString* error)
+{
+    if (store.open(path)) return true;
+    *error = path + ": " + store.errorString();
+    return false;
+}
+
+int commandStats(const QString& path)
+{
+    HistoryStore store;
+    QString error;
+    if (!openStore(store, path, &error)) return fail(error);
+
+    // Textumfang blockweise ermitteln
+    qint64 characters = 0;
+    store.forEach([&characters](int, const QJsonObject& entry) {
+        characters += entry["text"].toString().size();
+        return true;
+    });
+
+    QTextStream out(stdout);
+    out << "file:          " << path << Qt::endl;
+    out << "file size:     " << store.fileSize() << " bytes" << Qt::endl;
+    out << "unused bytes:  " << store.deadBytes() << Qt::endl;
+    out << "versions:      " << store.size() << Qt::endl;
+    out << "blocks:        " << store.blockCount() << Qt::endl;
+    out << "sealed shards: " << store.shardCount() << Qt::endl;
+    out << "current:       " << store.currentIndex() + 1 << Qt::endl;
+    out << "characters:    " << characters << Qt::endl;
+    return 0;
+}
+
+int commandVerify(const QString& path)
+{
+    // Erst nur die Prüfsummen, dann vollständig dekodieren, um den Anteil zu messen
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    if (!HistoryStore::verifyChecksums(path, &error)) {
+        QTextStream(stderr) << path << ": " << error << Qt::endl;
+        return 2;
+    }
+    const qint64 checksumNs = timer.nsecsElapsed();
+
+    timer.restart();
+    if (!HistoryStore::verify(path, &error)) {
+        QTextStream(stderr) << path << ": " << error << Qt::endl;
+        return 2;
+    }
+    const qint64 decodeNs = timer.nsecsElapsed();
+
+    QTextStream(stdout) << path << ": OK (checksums " << QString::number(checksumNs / 1e6, 'f', 2)
+                        << " ms" << (Crc32c::isHardwareAccelerated() ? ", hardware CRC32C" : "")
+                        << ", full decode " << QString::number(decodeNs / 1e6, 'f', 2) << " ms, "
+                        << QString::number(100.0 * checksumNs / qMax<qint64>(1, decodeNs), 'f', 2) << "%)" << Qt::endl;
+    return 0;
+}
+
+int commandDump(const QString& path, int version, const QString& at)
+{
+    HistoryStore store;
+    QString error;
+    if (!openStore(store, path, &error)) return fail(error);
+
+    int index = version > 0 ? version - 1 : store.currentIndex();
+    if (!at.isEmpty()) {
+        // Über den Zeitindex, ohne die History zu durchlaufen
+        const QDateTime time = QDateTime::fromString(at, Qt::ISODate);
+        if (!time.isValid()) return fail("invalid time: " + at);
+        index = store.versionAt(time.toMSecsSinceEpoch());
+        if (index < 0) return fail("no version existed at " + at);
+    }
+    if (index < 0 || index >= store.size()) {
+        return fail(QString("version %1 does not exist (1-%2)").arg(index + 1).arg(store.size()));
+    }
+
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    out.write(store.entry(index)["text"].toString().toUtf8());
+    return 0;
+}
+
+int commandExport(const QString& path, bool all, int version)
+{
+    HistoryStore store;
+    QString error;
+    if (!openStore(store, path, &error)) return fail(error);
+
+    // Eine Version pro Zeile als JSON, direkt nach stdout gestreamt
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    const int single = version > 0 ? version - 1 : store.currentIndex();
+    store.forEach([&](int index, const QJsonObject& entry) {
+        if (!all && index != single) return index < single;
+        QJsonObject line = entry;
+        line["version"] = index + 1;
+        out.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+        out.write("\n");
+        return all;
+    });
+    out.flush();
+    return 0;
+}
+
+int commandCompact(const QString& path)
+{
+    // Vollständig laden, damit beschädigte Blöcke nicht mitkopiert werden
+    HistoryStore store;
+    if (!store.load(path)) return fail(path + ": " + store.errorString());
+    if (store.wasRepaired()) {
+        QTextStream(stderr) << path << ": " << store.errorString() << Qt::endl;
+    }
+
+    const qint64 before = store.fileSize();
+    if (!store.compact()) return fail(path + ": " + QString("compaction failed"));
+    QTextStream(stdout) << path << ": " << before << " -> " << store.fileSize() << " bytes" << Qt::endl;
+    return 0;
+}
+
+int commandImport(const QString& path, const QString& input, bool replace)
+{
+    HistoryStore store;
+    QString error;
+    if (!openStore(store, path, &error) && !replace && QFile::exists(path)) return fail(error);
+    if (replace || !QFile::exists(path)) {
+        store.clear();
+    }
+
+    QFile in;
+    if (input.isEmpty() || input == "-") {
+        in.open(stdin, QIODevice::ReadOnly);
+    } else {
+        in.setFileName(input);
+        if (!in.open(QIODevice::ReadOnly)) return fail(input + ": cannot be opened");
+    }
+
+    // Kennungen fortlaufend hinter den vorhandenen vergeben, ältere Einträge ohne
+    // Kennung erhalten beim Laden ihre Position
+    qint64 nextId = store.size();
+    qint64 lastId = -1;
+    store.forEachLinks([&](int index, const QJsonObject& links) {
+        lastId = links.contains("id") ? links["id"].toInteger() : index;
+        nextId = qMax(nextId, lastId + 1);
+        return true;
+    });
+    QHash<qint64, qint64> ids;  // Kennung im Export -> neue Kennung
+
+    // Zeilen im Format von "export" einlesen, vollständige Blöcke sofort schreiben
+    int imported = 0;
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        const QByteArray line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject() || !doc.object()["text"].isString()) {
+            return fail(QString("%1:%2: invalid entry").arg(input.isEmpty() ? "-" : input).arg(lineNumber));
+        }
+        const QJsonObject source = doc.object();
+        QJsonObject entry;
+        entry["text"] = source["text"];
+        entry["cursor"] = source["cursor"].toInt();
+
+        // Zeitpunkt und Zweige übernehmen, Zeilen ohne Verweis hängen an der vorigen Version
+        const qint64 id = nextId++;
+        qint64 parentId = lastId;
+        if (source.contains("id")) {
+            parentId = ids.value(source["parentId"].toInteger(-1), -1);
+            ids.insert(source["id"].toInteger(), id);
+        }
+        UndoTree::storeLinks(entry, id, parentId, source["time"].toInteger());
+        lastId = id;
+        store.append(entry);
+        ++imported;
+
+        if (imported % HistoryStore::BLOCK_ENTRIES == 0) {
+            store.setCurrentIndex(store.size() - 1);
+            if (!store.save()) return fail(path + ": write failed");
+            store.releaseCache();
+        }
+    }
+
+    store.setCurrentIndex(store.size() - 1);
+    if (!store.save()) return fail(path + ": write failed");
+    QTextStream(stdout) << "imported " << imported << " versions, " << store.size() << " in total" << Qt::endl;
+    return 0;
+}
+
+
+/**
+ * @brief Zufällige Zeile aus Kleinbuchstaben und Leerzeichen, im Mittel lineLength Zeichen
+ */
+QString generateLine(QRandomGenerator& random, int lineLength)
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz     ";
+    const int length = lineLength / 2 + int(random.bounded(lineLength + 1));
+    QString line(length, Qt::Uninitialized);
+    for (int k = 0; k < length; ++k) {
+        line[k] = QLatin1Char(alphabet[random.bounded(int(sizeof(alphabet) - 1))]);
+    }
+    return line;
+}
+
+/**
+ * @brief Lehrbuch-LCS über alle Zeilen ohne Abschneiden und Hashing
+ *
+ * Liefert nur die Anzahl gemeinsamer Zeilen (zwei Zeilen der Tabelle), der
+ * Aufwand von O(N*M) Zeilenvergleichen bleibt derselbe.
+ */
+qint64 naiveCommonLines(const QList<QStringView>& a, const QList<QStringView>& b)
+{
+    std::vector<qint64> previous(b.size() + 1, 0);
+    std::vector<qint64> current(b.size() + 1, 0);
+    for (qsizetype i = 1; i <= a.size(); ++i) {
+        for (qsizetype j = 1; j <= b.size(); ++j) {
+            current[j] = a[i - 1] == b[j - 1] ? previous[j - 1] + 1 : qMax(previous[j], current[j - 1]);
+        }
+        std::swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+qsizetype scalarCommonPrefix(const QChar* a, const QChar* b, qsizetype n)
+{
+    for (qsizetype i = 0; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return n;
+}
+
+QString milliseconds(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 2) + " ms";
+}
+
+int commandBenchDiff(qint64 characters, int edits, int lineLength)
+{
+    if (characters <= 0 || edits < 0 || lineLength <= 0) return fail("invalid benchmark parameters");
+
+    // Zwei Versionen mit festem Startwert, damit Läufe vergleichbar bleiben
+    QRandomGenerator random(4711);
+    QStringList lines;
+    qint64 generated = 0;
+    while (generated < characters) {
+        lines.append(generateLine(random, lineLength));
+        generated += lines.last().size() + 1;
+    }
+    const QString oldText = lines.join(QLatin1Char('\n'));
+    for (int k = 0; k < edits && !lines.isEmpty(); ++k) {
+        const int line = int(random.bounded(int(lines.size())));
+        switch (random.bounded(3)) {
+        case 0: lines[line] = generateLine(random, lineLength); break;
+        case 1: lines.insert(line, generateLine(random, lineLength)); break;
+        default: lines.removeAt(line); break;
+        }
+    }
+    const QString newText = lines.join(QLatin1Char('\n'));
+    lines.clear();
+
+    QTextStream out(stdout);
+    out << "old version:   " << oldText.size() << " characters" << Qt::endl;
+    out << "new version:   " << newText.size() << " characters, " << edits << " line edits" << Qt::endl;
+
+    // Gemeinsamer Anfang zweier gleicher Puffer: SIMD gegen Zeichen für Zeichen
+    const QString copy(oldText.constData(), oldText.size());
+    QElapsedTimer timer;
+    timer.start();
+    const qsizetype simdPrefix = DiffEngine::commonPrefix(oldText.constData(), copy.constData(), oldText.size());
+    const qint64 simdPrefixNs = timer.nsecsElapsed();
+    timer.restart();
+    const qsizetype scalarPrefix = scalarCommonPrefix(oldText.constData(), copy.constData(), oldText.size());
+    const qint64 scalarPrefixNs = timer.nsecsElapsed();
+    if (simdPrefix != scalarPrefix) return fail("prefix lengths differ");
+    out << "common prefix: " << milliseconds(simdPrefixNs) << " (scalar " << milliseconds(scalarPrefixNs) << ")" << Qt::endl;
+
+    timer.restart();
+    const QVector<DiffEngine::Hunk> hunks = DiffEngine::diffLines(oldText, newText);
+    const qint64 diffNs = timer.nsecsElapsed();
+    qint64 equalLines = 0;
+    for (const DiffEngine::Hunk& hunk : hunks) {
+        if (hunk.type == DiffEngine::OpType::Equal) equalLines += hunk.count;
+    }
+    out << "diffLines:     " << milliseconds(diffNs) << ", " << hunks.size() << " hunks" << Qt::endl;
+
+    const QList<QStringView> oldLines = QStringView(oldText).split(QLatin1Char('\n'));
+    const QList<QStringView> newLines = QStringView(newText).split(QLatin1Char('\n'));
+    const double cells = double(oldLines.size()) * double(newLines.size());
+    if (cells > NAIVE_DIFF_CELLS) {
+        out << "naive LCS:     skipped (" << QString::number(cells, 'g', 3)
+            << " line comparisons, use a smaller --size or longer --line-length)" << Qt::endl;
+        return 0;
+    }
+
+    timer.restart();
+    const qint64 naiveEqualLines = naiveCommonLines(oldLines, newLines);
+    const qint64 naiveNs = timer.nsecsElapsed();
+    out << "naive LCS:     " << milliseconds(naiveNs) << " ("
+        << QString::number(double(naiveNs) / qMax<qint64>(1, diffNs), 'f', 0) << "x)" << Qt::endl;
+
+    // Myers liefert ein kürzestes Skript, also gleich viele gemeinsame Zeilen
+    if (naiveEqualLines != equalLines) {
+        return fail(QString("diffLines kept %1 lines, naive LCS %2").arg(equalLines).arg(naiveEqualLines));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quicknote-history");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Inspect and maintain the QuickNote history without the GUI.\n\n"
+        "Commands:\n"
+        "  stats              Show size and version counts\n"
+        "  verify             Check block checksums, decode every block and report damage\n"
+        "  dump               Print the text of one version (--version or --at)\n"
+        "  export             Write versions as JSON lines to stdout\n"
+        "  compact            Rewrite the file, drop unused space and damaged blocks\n"
+        "  import [FILE]      Append versions from JSON lines (FILE or stdin)\n"
+        "  bench-diff         Time the line diff against a naive LCS on generated versions\n\n"
+        "Do not run compact or import while QuickNote is running.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "stats, verify, dump, export, compact, import or bench-diff");
+    const QCommandLineOption fileOption("file", "History file to use.", "path", defaultHistoryFile());
+    const QCommandLineOption versionOption("version", "Version number (1-based), default is the current one.", "N");
+    const QCommandLineOption atOption("at", "Dump the version that was current at this time (ISO 8601).", "time");
+    const QCommandLineOption allOption("all", "Export all versions.");
+    const QCommandLineOption replaceOption("replace", "Replace the history instead of appending on import.");
+    const QCommandLineOption sizeOption("size", "Characters per generated version for bench-diff.", "N",
+                                        QString::number(10 * 1024 * 1024));
+    const QCommandLineOption editsOption("edits", "Changed lines between the versions for bench-diff.", "N", "100");
+    const QCommandLineOption lineLengthOption("line-length", "Average line length for bench-diff.", "N", "400");
+    parser.addOption(fileOption);
+    parser.addOption(versionOption);
+    parser.addOption(atOption);
+    parser.addOption(allOption);
+    parser.addOption(replaceOption);
+    parser.addOption(sizeOption);
+    parser.addOption(editsOption);
+    parser.addOption(lineLengthOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString command = args.first();
+    const QString path = parser.value(fileOption);
+    const int version = parser.value(versionOption).toInt();
+
+    if (command == "stats") return commandStats(path);
+    if (command == "verify") return commandVerify(path);
+    if (command == "dump") return commandDump(path, version, parser.value(atOption));
+    if (command == "export") return commandExport(path, parser.isSet(allOption), version);
+    if (command == "compact") return commandCompact(path);
+    if (command == "import") return commandImport(path, args.value(1), parser.isSet(replaceOption));
+    if (command == "bench-diff") {
+        return commandBenchDiff(parser.value(sizeOption).toLongLong(), parser.value(editsOption).toInt(),
+                                parser.value(lineLengthOption).toInt());
+    }
+
+    return fail("unknown command: " + command);
+}
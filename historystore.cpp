@@ -0,0 +1,1758 @@
+#include "historystore.h"
+#include "parallel.h"
+#include "crc32c.h"
+#include "fingerprint.h"
+#include "deltacodec.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QThreadPool>
+#include <QObject>
+#include <QDebug>
+#include <QMultiHash>
+#include <QCache>
+#include <QDataStream>
+#include <QMutex>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+const char FILE_MAGIC[] = "QNHB";
+const char BLOCK_MAGIC[] = "QNBK";
+const char INDEX_MAGIC[] = "QNIX";
+const char END_MAGIC[] = "QNHE";
+const quint32 FORMAT_VERSION = 4;
+const qint64 HEADER_SIZE = 8;
+const qint64 BLOCK_HEADER_SIZE = 16;
+const qint64 BLOCK_HEADER_SIZE_V1 = 12;  // Formatversion 1, ohne Prüfsumme
+const qint64 INDEX_HEADER_SIZE = 8;
+const qint64 TRAILER_SIZE = 12;
+
+void appendU32(QByteArray& out, quint32 value)
+{
+    char buffer[4];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 4);
+}
+
+void appendU64(QByteArray& out, quint64 value)
+{
+    char buffer[8];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 8);
+}
+
+quint32 readU32(const QByteArray& data, qint64 pos)
+{
+    return qFromLittleEndian<quint32>(data.constData() + pos);
+}
+
+quint64 readU64(const QByteArray& data, qint64 pos)
+{
+    return qFromLittleEndian<quint64>(data.constData() + pos);
+}
+
+bool hasMagic(const QByteArray& data, qint64 pos, const char* magic)
+{
+    return pos >= 0 && pos + 4 <= data.size() && std::memcmp(data.constData() + pos, magic, 4) == 0;
+}
+
+/**
+ * @brief Prüfsumme über Länge, Anzahl und Nutzdaten eines Blocks
+ */
+quint32 blockChecksum(const char* lengthAndCount, const char* payload, qint64 length)
+{
+    return Crc32c::compute(payload, length, Crc32c::compute(lengthAndCount, 8));
+}
+
+/**
+ * @brief Prüft Kopf und Prüfsumme eines Blocks, ohne ihn zu dekomprimieren
+ */
+bool blockIntact(const QByteArray& encoded)
+{
+    if (encoded.size() < BLOCK_HEADER_SIZE || !hasMagic(encoded, 0, BLOCK_MAGIC)) return false;
+    const quint32 length = readU32(encoded, 4);
+    if (BLOCK_HEADER_SIZE + length != quint64(encoded.size())) return false;
+    return readU32(encoded, 12) == blockChecksum(encoded.constData() + 4, encoded.constData() + BLOCK_HEADER_SIZE, length);
+}
+
+/**
+ * @brief Wandelt einen Block der Formatversion 1 um, indem die Prüfsumme ergänzt wird
+ */
+QByteArray upgradeBlock(const QByteArray& encoded)
+{
+    if (encoded.size() < BLOCK_HEADER_SIZE_V1 || !hasMagic(encoded, 0, BLOCK_MAGIC)) return QByteArray();
+    const quint32 length = readU32(encoded, 4);
+    if (BLOCK_HEADER_SIZE_V1 + length != quint64(encoded.size())) return QByteArray();
+
+    QByteArray block = encoded.left(BLOCK_HEADER_SIZE_V1);
+    appendU32(block, blockChecksum(encoded.constData() + 4, encoded.constData() + BLOCK_HEADER_SIZE_V1, length));
+    block.append(encoded.constData() + BLOCK_HEADER_SIZE_V1, length);
+    return block;
+}
+
+/**
+ * @brief Kennung, Vorgänger und Zeitpunkt eines Eintrags für den Index eines Abschnitts
+ */
+QJsonObject linksOf(const QJsonObject& entry)
+{
+    QJsonObject links;
+    for (const char* key : {"id", "parentId", "parent", "time"}) {
+        const QString name = QString::fromLatin1(key);
+        if (entry.contains(name)) links[name] = entry[name];
+    }
+    return links;
+}
+
+QByteArray encodeIndex(const QJsonObject& index)
+{
+    const QByteArray payload = compressData(QJsonDocument(index).toJson(QJsonDocument::Compact));
+    QByteArray record(INDEX_MAGIC, 4);
+    appendU32(record, payload.size());
+    record.append(payload);
+    return record;
+}
+
+/**
+ * @brief Liest den Index über den Abschluss, der bei fileSize endet
+ */
+bool readIndex(QFile& file, qint64 fileSize, QJsonObject* index, qint64* indexOffset, QString* error)
+{
+    if (fileSize < HEADER_SIZE + TRAILER_SIZE) {
+        *error = "Datei ist zu kurz";
+        return false;
+    }
+    file.seek(fileSize - TRAILER_SIZE);
+    const QByteArray trailer = file.read(TRAILER_SIZE);
+    if (trailer.size() != TRAILER_SIZE || !hasMagic(trailer, 8, END_MAGIC)) {
+        *error = "Dateiende fehlt";
+        return false;
+    }
+    const quint64 offset = readU64(trailer, 0);
+    if (offset < quint64(HEADER_SIZE) || offset + INDEX_HEADER_SIZE > quint64(fileSize - TRAILER_SIZE)) {
+        *error = "Index beschädigt";
+        return false;
+    }
+    file.seek(qint64(offset));
+    const QByteArray indexHeader = file.read(INDEX_HEADER_SIZE);
+    if (!hasMagic(indexHeader, 0, INDEX_MAGIC)) {
+        *error = "Index beschädigt";
+        return false;
+    }
+    const quint32 length = readU32(indexHeader, 4);
+    if (offset + INDEX_HEADER_SIZE + length > quint64(fileSize - TRAILER_SIZE)) {
+        *error = "Index beschädigt";
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(decompressData(file.read(length)), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        *error = "Index nicht lesbar";
+        return false;
+    }
+    *index = doc.object();
+    *indexOffset = qint64(offset);
+    return true;
+}
+
+/**
+ * @brief Sucht nach einem abgebrochenen Anhängen den letzten vollständigen Abschluss
+ *
+ * Geänderte Blöcke werden hinter den gültigen Index geschrieben, dieser
+ * bleibt samt Abschluss erhalten, bis der neue vollständig ist.
+ * @param end Ende des gefundenen Abschlusses
+ */
+bool readEarlierIndex(QFile& file, QJsonObject* index, qint64* indexOffset, qint64* end)
+{
+    file.seek(0);
+    const QByteArray data = file.readAll();
+    QString ignored;
+    for (qint64 pos = data.lastIndexOf(END_MAGIC); pos >= HEADER_SIZE + TRAILER_SIZE - 4;
+         pos = data.lastIndexOf(END_MAGIC, pos - 1)) {
+        if (readIndex(file, pos + 4, index, indexOffset, &ignored)) {
+            *end = pos + 4;
+            return true;
+        }
+    }
+    return false;
+}
+
+const int DELTA_MIN_BYTES = 16 * 1024;     // Kleinere Texte findet gzip im Block schon beim Vorgänger
+const int DELTA_CACHE_BYTES = 8 << 20;
+const int KEYFRAME_INTERVAL = 16;           // Differenzen pro Schlüsselbild bei großen Notizen
+
+/**
+ * @brief Anteil eines Texts an BLOCK_TEXT_BYTES
+ *
+ * Große Texte zählen unabhängig von ihrer Länge: das Schlüsselbild gar
+ * nicht, jede Differenz ein KEYFRAME_INTERVAL-tel. Sonst schlösse schon das
+ * Schlüsselbild einer Notiz ab 512K Zeichen den Block, und es entstünde
+ * nie eine Differenz. Wird ein großer Text doch vollständig abgelegt, weil
+ * sich die Differenz nicht lohnt, zählt er voll.
+ * @param delta false wenn der Text vollständig im Block steht
+ */
+qint64 textCost(const QString& text, bool keyframe, bool delta = true)
+{
+    const qint64 bytes = text.size() * qint64(sizeof(QChar));
+    if (text.size() < DELTA_MIN_BYTES) return bytes;
+    if (keyframe) return 0;
+    return delta ? HistoryStore::BLOCK_TEXT_BYTES / KEYFRAME_INTERVAL : bytes;
+}
+
+/**
+ * @brief Differenz zum Vorgänger samt Länge des Texts in UTF-8
+ *
+ * Vorgänger und Text werden mitgeführt (implizit geteilt), damit ein
+ * Treffer im Cache gegen die tatsächlichen Texte geprüft werden kann.
+ */
+struct Delta {
+    QString previous;
+    QString text;
+    QByteArray data;    // Leer, wenn sie sich nicht lohnt
+    qint64 bytes = 0;
+};
+
+/**
+ * @brief Zuletzt berechnete Differenzen, nach Fingerprint und Länge von Vorgänger und Text
+ *
+ * Der letzte Block wird bei jedem Speichern neu kodiert, seine älteren
+ * Einträge ändern sich dabei nicht und werden ohne Umwandlung nach UTF-8
+ * gefunden. Der Fingerprint kommt ungeprüft aus "fp", verwendet wird ein
+ * Treffer daher nur, wenn beide Texte gleich sind. Kodiert wird auch im
+ * Thread-Pool, daher mit Mutex.
+ */
+struct DeltaCache {
+    QMutex mutex;
+    QCache<QByteArray, Delta> deltas{DELTA_CACHE_BYTES};
+};
+
+DeltaCache& deltaCache()
+{
+    static DeltaCache cache;
+    return cache;
+}
+
+QByteArray deltaKey(quint64 previousFingerprint, const QString& previous, quint64 fingerprint, const QString& text)
+{
+    QByteArray key;
+    QDataStream(&key, QIODevice::WriteOnly) << previousFingerprint << qint64(previous.size())
+                                           << fingerprint << qint64(text.size());
+    return key;
+}
+
+/**
+ * @brief Differenz zum Vorgänger, aus dem Cache oder neu berechnet
+ */
+Delta deltaOf(quint64 previousFingerprint, const QString& previous, quint64 fingerprint, const QString& text)
+{
+    const QByteArray key = deltaKey(previousFingerprint, previous, fingerprint, text);
+    DeltaCache& cache = deltaCache();
+    {
+        QMutexLocker locker(&cache.mutex);
+        const Delta* cached = cache.deltas.object(key);
+        if (cached && cached->previous == previous && cached->text == text) return *cached;
+    }
+    const QByteArray bytes = text.toUtf8();
+    Delta delta;
+    delta.previous = previous;
+    delta.text = text;
+    delta.bytes = bytes.size();
+    delta.data = DeltaCodec::encode(previous.toUtf8(), bytes);
+    if (delta.data.size() > bytes.size() / 4) delta.data.clear();  // Kaum Gemeinsamkeiten, gzip im Block genügt
+    QMutexLocker locker(&cache.mutex);
+    // Auch verworfene Differenzen halten ihre Texte, daher mit Mindestkosten
+    cache.deltas.insert(key, new Delta(delta), qMax<qsizetype>(DELTA_MIN_BYTES, delta.data.size()));
+    return delta;
+}
+
+} // namespace
+
+/**
+ * @brief Komprimiert Daten mit zlib im gzip-Format
+ */
+QByteArray compressData(const QByteArray& data)
+{
+    // Initialisiert die zlib-Struktur
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+
+    // Initialisiert den Kompressor im gzip-Format
+    deflateInit2(&zs,
+                1,              // Level 1 = schnellste Kompression
+                Z_DEFLATED,     // Komprimierungsmethode
+                31,            // 15 für normale Kompression + 16 für gzip header
+                8,             // Standard Speicherlevel
+                Z_DEFAULT_STRATEGY);
+
+    // Erstellt einen Puffer, der auch für nicht komprimierbare Daten reicht
+    QByteArray compressed;
+    compressed.resize(deflateBound(&zs, data.size()));
+
+    // Setzt die Ein- und Ausgabeparameter
+    zs.avail_in = data.size();
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_out = compressed.size();
+    zs.next_out = (Bytef*)compressed.data();
+
+    // Führt die Kompression durch
+    deflate(&zs, Z_FINISH);
+    compressed.resize(zs.total_out);
+    deflateEnd(&zs);
+
+    return compressed;
+}
+
+/**
+ * @brief Dekomprimiert gzip-komprimierte Daten
+ */
+QByteArray decompressData(const QByteArray& data)
+{
+    if (data.isEmpty()) return QByteArray();
+
+    QByteArray decompressed;
+    const int CHUNK = 16384;
+    decompressed.resize(CHUNK);
+
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    zs.avail_in = data.size();
+    zs.next_in = (Bytef*)data.data();
+
+    if (inflateInit2(&zs, 47) != Z_OK) {
+        qDebug() << "Fehler bei inflateInit2";
+        return QByteArray();
+    }
+
+    int ret;
+    do {
+        zs.avail_out = CHUNK;
+        zs.next_out = (Bytef*)(decompressed.data() + zs.total_out);
+
+        ret = inflate(&zs, Z_NO_FLUSH);
+
+        if (ret < 0) {
+            qDebug() << "Fehler bei inflate:" << ret;
+            inflateEnd(&zs);
+            return QByteArray();
+        }
+
+        if (zs.avail_out == 0) {
+            decompressed.resize(decompressed.size() + CHUNK);
+        }
+
+    } while (ret != Z_STREAM_END);
+
+    decompressed.resize(zs.total_out);
+    inflateEnd(&zs);
+
+    return decompressed;
+}
+
+
+HistoryStore::HistoryStore()
+    : m_firstPosition(0), m_size(0), m_firstDirty(0), m_fileValid(false), m_deadBytes(0), m_fileSize(0),
+      m_spareStart(0), m_spareEnd(0),
+      m_backgroundJobs(0), m_saveRequested(false), m_revision(0), m_fileVersion(FORMAT_VERSION), m_repaired(false),
+      m_timesValid(true), m_fileGuard(std::make_shared<FileGuard>()),
+      m_background(std::make_shared<Background>()), m_writes(0), m_snapshot(false)
+{
+}
+
+HistoryStore HistoryStore::snapshot() const
+{
+    HistoryStore copy(*this);
+    copy.m_snapshot = true;
+    copy.m_backgroundJobs = 0;
+    copy.m_saveRequested = false;
+    return copy;
+}
+
+/**
+ * @brief true wenn die Stelle des Blocks in der Datei seit m_writes nicht überschrieben wurde
+ *
+ * Muss mit gehaltener Lesesperre aufgerufen werden.
+ */
+bool HistoryStore::blockUnchanged(const Block& block) const
+{
+    const quint64 writes = m_fileGuard->writes;
+    if (writes - m_writes > quint64(FileGuard::WRITE_HISTORY)) return false;
+    for (quint64 w = m_writes; w < writes; ++w) {
+        if (block.offset + block.diskSize > m_fileGuard->writeStart[w % FileGuard::WRITE_HISTORY]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Vermerkt einen Schreibvorgang ab position, muss mit Schreibsperre aufgerufen werden
+ */
+void HistoryStore::recordWrite(qint64 position)
+{
+    m_fileGuard->writeStart[m_fileGuard->writes % FileGuard::WRITE_HISTORY] = position;
+    m_writes = ++m_fileGuard->writes;
+}
+
+/**
+ * @brief Kodiert einen Block, gleiche Texte werden nur einmal abgelegt
+ *
+ * Texte ab DELTA_MIN_BYTES werden als Differenz zum vorherigen Eintrag
+ * abgelegt (siehe DeltaCodec), Schlüsselbild ist der erste Eintrag des
+ * Blocks.
+ *
+ * Ein Eintrag, dessen Text schon weiter vorn im Block steht, erhält statt
+ * "text" den Verweis "same" auf dessen Position im Block. Erkannt werden
+ * Kandidaten am Fingerprint ("fp", sonst aus dem Text berechnet), bestätigt
+ * durch Vergleich der Texte. Verweise bleiben innerhalb des Blocks, damit
+ * jeder Block unabhängig dekodierbar bleibt.
+ * @param textBytes Erhält die Textmenge nach textCost(), je nachdem ob eine Differenz abgelegt wurde
+ */
+QByteArray HistoryStore::encodeBlock(const QJsonArray& entries, qint64* textBytes)
+{
+    QJsonArray stored = entries;
+    QMultiHash<quint64, int> seen;      // Fingerprint -> Position eines Eintrags mit Text
+    QVector<QString> texts(entries.size());
+    QVector<quint64> fingerprints(entries.size());
+    for (int k = 0; k < entries.size(); ++k) {
+        const QJsonObject entry = entries[k].toObject();
+        texts[k] = entry["text"].toString();
+        quint64& fingerprint = fingerprints[k];
+        if (!Fingerprint::fromString(entry["fp"].toString(), &fingerprint)) fingerprint = Fingerprint::ofNote(texts[k]);
+
+        int same = -1;
+        for (auto it = seen.constFind(fingerprint); it != seen.constEnd() && it.key() == fingerprint; ++it) {
+            if (texts[it.value()] == texts[k]) {
+                same = it.value();
+                break;
+            }
+        }
+        if (same < 0) {
+            seen.insert(fingerprint, k);
+        } else if (!texts[k].isEmpty()) {
+            QJsonObject reference = entry;
+            reference.remove("text");
+            reference["same"] = same;
+            stored.replace(k, reference);
+        }
+    }
+
+    // Große Texte als Differenz zum vorherigen Eintrag, der erste im Block bleibt vollständig
+    for (int k = 1; k < entries.size(); ++k) {
+        if (texts[k].size() < DELTA_MIN_BYTES || texts[k - 1].isEmpty() || stored[k].toObject().contains("same")) {
+            continue;
+        }
+        const Delta delta = deltaOf(fingerprints[k - 1], texts[k - 1], fingerprints[k], texts[k]);
+        if (!delta.data.isEmpty()) {
+            QJsonObject reference = stored[k].toObject();
+            reference.remove("text");
+            reference["delta"] = QString::fromLatin1(delta.data.toBase64());
+            reference["bytes"] = delta.bytes;
+            stored.replace(k, reference);
+        }
+    }
+    if (textBytes) {
+        *textBytes = 0;
+        for (int k = 0; k < entries.size(); ++k) {
+            *textBytes += textCost(texts[k], k == 0, !stored[k].toObject().contains("text"));
+        }
+    }
+
+    const QByteArray payload = compressData(QJsonDocument(stored).toJson(QJsonDocument::Compact));
+    QByteArray block;
+    block.reserve(BLOCK_HEADER_SIZE + payload.size());
+    block.append(BLOCK_MAGIC, 4);
+    appendU32(block, payload.size());
+    appendU32(block, entries.size());
+    appendU32(block, blockChecksum(block.constData() + 4, payload.constData(), payload.size()));
+    block.append(payload);
+    return block;
+}
+
+bool HistoryStore::decodeBlock(const QByteArray& encoded, QJsonArray* entries, qint64* textBytes)
+{
+    // Prüfsumme vor dem Dekomprimieren, kostet nur einen Bruchteil davon
+    if (!blockIntact(encoded)) return false;
+    const quint32 count = readU32(encoded, 8);
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(decompressData(encoded.mid(BLOCK_HEADER_SIZE)), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) return false;
+    *entries = doc.array();
+    if (quint32(entries->size()) != count) return false;
+
+    // Verweise auf gleiche Texte und Differenzen zum Vorgänger der Reihe nach auflösen
+    QByteArray previous;    // UTF-8 des Vorgängers, wenn er selbst eine Differenz war
+    if (textBytes) *textBytes = 0;
+    for (int k = 0; k < entries->size(); ++k) {
+        QJsonObject entry = entries->at(k).toObject();
+        const bool full = entry.contains("text");
+        QByteArray bytes;
+        if (entry.contains("same")) {
+            const int same = entry["same"].toInt(-1);
+            if (same < 0 || same >= k) return false;
+            entry["text"] = entries->at(same).toObject()["text"];
+            entry.remove("same");
+            entries->replace(k, entry);
+        } else if (entry.contains("delta")) {
+            if (k == 0) return false;
+            if (previous.isNull()) previous = entries->at(k - 1).toObject()["text"].toString().toUtf8();
+            const QByteArray delta = QByteArray::fromBase64(entry["delta"].toString().toLatin1());
+            if (!DeltaCodec::decode(previous, delta, entry["bytes"].toInteger(-1), &bytes)) return false;
+            entry["text"] = QString::fromUtf8(bytes);
+            entry.remove("delta");
+            entry.remove("bytes");
+            entries->replace(k, entry);
+        }
+        if (textBytes) *textBytes += textCost(entry["text"].toString(), k == 0, !full);
+        previous = bytes;
+    }
+    return true;
+}
+
+/**
+ * @brief Schätzt die Textmenge eines Blocks ohne zu kodieren
+ *
+ * Nimmt für große Texte eine Differenz an; encodeBlock() und decodeBlock()
+ * liefern den tatsächlichen Wert.
+ */
+qint64 HistoryStore::textBytesOf(const QJsonArray& entries)
+{
+    qint64 bytes = 0;
+    for (int k = 0; k < entries.size(); ++k) {
+        bytes += textCost(entries[k].toObject()["text"].toString(), k == 0);
+    }
+    return bytes;
+}
+
+/**
+ * @brief Liest das alte Format: eine einzige gzip-Datei mit der kompletten History als JSON
+ */
+bool HistoryStore::loadLegacy(const QByteArray& compressedData)
+{
+    QByteArray data = decompressData(compressedData);
+    if (data.isEmpty()) {
+        m_errorString = "Dekomprimierte Daten sind leer";
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        m_errorString = "JSON Parse Fehler: " + parseError.errorString();
+        return false;
+    }
+    if (!doc.isObject()) {
+        m_errorString = "JSON-Dokument ist kein Objekt";
+        return false;
+    }
+
+    QJsonObject saveData = doc.object();
+    if (!saveData.contains("history") || !saveData["history"].isArray()) {
+        m_errorString = "Keine gültige History in den Daten gefunden";
+        return false;
+    }
+
+    const QJsonArray history = saveData["history"].toArray();
+    for (const QJsonValue& value : history) {
+        append(value.toObject());
+    }
+    m_state = saveData["state"].toObject();
+    m_fileValid = false;  // Beim nächsten Speichern ins Blockformat umwandeln
+    return true;
+}
+
+bool HistoryStore::open(const QString& path)
+{
+    clear();
+    m_deadShards.clear();  // Gehören zur vorherigen Datei
+    m_path = path;
+    m_errorString.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = "Datei kann nicht geöffnet werden";
+        return false;
+    }
+    m_fileSize = file.size();
+
+    // gzip-Kennung: Datei im alten Format
+    if (file.peek(2) == QByteArray("\x1f\x8b")) {
+        return loadLegacy(file.readAll());
+    }
+
+    const QByteArray header = file.read(HEADER_SIZE);
+    if (header.size() != HEADER_SIZE || !hasMagic(header, 0, FILE_MAGIC)) {
+        m_errorString = "Kein History-Blockformat";
+        return false;
+    }
+    m_fileVersion = readU32(header, 4);
+    if (m_fileVersion < 1 || m_fileVersion > FORMAT_VERSION) {
+        m_errorString = QString("Unbekannte Formatversion %1").arg(m_fileVersion);
+        return false;
+    }
+
+    QJsonObject index;
+    qint64 indexOffset = 0;
+    m_spareStart = m_spareEnd = 0;
+    if (!readIndex(file, m_fileSize, &index, &indexOffset, &m_errorString)) {
+        // Abgebrochenes Anhängen: der vorherige Stand ist vollständig, dahinter ist alles frei
+        if (!readEarlierIndex(file, &index, &indexOffset, &m_fileSize)) {
+            // Sonst Blöcke ohne Index einsammeln
+            return recover(file);
+        }
+        m_errorString.clear();
+    }
+
+    // Abgeschlossene Abschnitte liegen vor den Blöcken der aktiven Datei
+    const QJsonArray shardList = index["shards"].toArray();
+    const QJsonArray blockList = index["blocks"].toArray();
+    QVector<Block> blocks(shardList.size() + blockList.size());
+    qint64 position = 0;
+    for (int s = 0; s < shardList.size(); ++s) {
+        const QJsonArray info = shardList[s].toArray();
+        Block& block = blocks[s];
+        block.shard = info.at(0).toString();
+        block.count = info.at(1).toInt();
+        block.first = position;
+        block.decoded = false;
+        block.dirty = false;
+        if (block.shard.isEmpty() || block.shard.contains('/') || block.count <= 0) {
+            m_errorString = "Abschnittsliste ist ungültig";
+            return false;
+        }
+        position += block.count;
+    }
+
+    qint64 end = HEADER_SIZE;
+    for (int b = 0; b < blockList.size(); ++b) {
+        const QJsonArray info = blockList[b].toArray();
+        Block& block = blocks[shardList.size() + b];
+        block.offset = info.at(0).toInteger();
+        block.diskSize = info.at(1).toInteger();
+        block.count = info.at(2).toInt();
+        block.first = position;
+        block.decoded = false;
+        block.dirty = false;
+        if (block.offset < end || block.diskSize < BLOCK_HEADER_SIZE || block.count < 0
+            || block.offset + block.diskSize > indexOffset) {
+            m_errorString = "Blockliste ist ungültig";
+            return recover(file);
+        }
+        end = block.offset + block.diskSize;
+        position += block.count;
+    }
+
+    const int skip = index["skip"].toInt();
+    if (skip < 0 || skip > position || (!blocks.isEmpty() && skip > blocks.first().count)) {
+        m_errorString = "Ungültiger Beginn der History";
+        return false;
+    }
+
+    m_blocks = blocks;
+    m_firstPosition = skip;
+    m_size = int(position - skip);
+    m_firstDirty = m_blocks.size();
+    m_fileValid = true;
+    m_deadBytes = indexOffset - HEADER_SIZE;
+    for (int b = shardList.size(); b < m_blocks.size(); ++b) {
+        m_deadBytes -= m_blocks[b].diskSize;
+    }
+    m_state = index["state"].toObject();
+
+    // Ohne passenden Zeitindex wird er bei Bedarf aus den Einträgen aufgebaut
+    m_timesValid = TimeIndex::deserialize(QByteArray::fromBase64(index["times"].toString().toLatin1()), &m_times)
+                   && m_times.size() == m_size;
+    return true;
+}
+
+/**
+ * @brief Sucht die Blöcke einer Datei ohne lesbaren Index der Reihe nach
+ *
+ * Jeder Block mit gültiger Prüfsumme wird übernommen, dazwischen wird
+ * byteweise nach der nächsten Blockkennung gesucht. Die Datei wird beim
+ * nächsten Speichern vollständig neu geschrieben.
+ */
+bool HistoryStore::recover(QFile& file)
+{
+    const QString reason = m_errorString;
+    file.seek(0);
+    const QByteArray data = file.readAll();
+    const qint64 headerSize = m_fileVersion >= 2 ? BLOCK_HEADER_SIZE : BLOCK_HEADER_SIZE_V1;
+
+    // Abschnittsdateien stehen nur im verlorenen Index, daher nach Namen suchen
+    QVector<Block> blocks;
+    qint64 position = 0;
+    const QFileInfo info(m_path);
+    const QStringList shardNames = info.dir().entryList({info.fileName() + ".*.shard"}, QDir::Files, QDir::Name);
+    for (const QString& name : shardNames) {
+        HistoryStore shard;
+        if (!shard.open(shardPath(name)) || shard.wasRepaired() || shard.isEmpty()) continue;
+        Block block;
+        block.shard = name;
+        block.count = shard.size();
+        block.first = position;
+        block.decoded = false;
+        block.dirty = false;
+        blocks.append(block);
+        position += block.count;
+    }
+    const int shardBlocks = blocks.size();
+
+    qint64 skippedBytes = 0;
+    qint64 pos = HEADER_SIZE;
+    while (pos + headerSize <= data.size()) {
+        if (!hasMagic(data, pos, BLOCK_MAGIC)) {
+            const qint64 next = data.indexOf(BLOCK_MAGIC, pos + 1);
+            skippedBytes += (next < 0 ? data.size() : next) - pos;
+            if (next < 0) break;
+            pos = next;
+            continue;
+        }
+
+        const quint32 length = readU32(data, pos + 4);
+        QByteArray encoded;
+        if (pos + headerSize + qint64(length) <= data.size()) {
+            encoded = data.mid(pos, headerSize + length);
+            if (m_fileVersion < 2) encoded = upgradeBlock(encoded);
+        }
+        QJsonArray entries;
+        const bool intact = m_fileVersion >= 2 ? blockIntact(encoded) : decodeBlock(encoded, &entries);
+        if (!intact) {
+            ++pos;
+            continue;
+        }
+
+        Block block;
+        block.encoded = encoded;
+        block.count = int(readU32(encoded, 8));
+        block.first = position;
+        block.decoded = false;
+        block.revision = ++m_revision;
+        blocks.append(block);
+        position += block.count;
+        pos += headerSize + length;
+    }
+
+    if (blocks.size() == shardBlocks) {
+        m_errorString = reason + ", keine lesbaren Blöcke gefunden";
+        return false;
+    }
+
+    m_blocks = blocks;
+    m_firstPosition = 0;
+    m_size = int(position);
+    m_firstDirty = 0;
+    m_fileValid = false;
+    m_deadBytes = 0;
+    m_state = QJsonObject();
+    setCurrentIndex(m_size - 1);
+    m_repaired = true;
+    m_timesValid = false;
+    m_errorString = QString("%1, %2 Blöcke und %3 Abschnitte mit %4 Versionen wiederhergestellt, %5 Bytes übersprungen")
+                        .arg(reason).arg(blocks.size() - shardBlocks).arg(shardBlocks).arg(m_size).arg(skippedBytes);
+    return true;
+}
+
+/**
+ * @brief Lädt die Datei vollständig, beschädigte Blöcke werden dabei verworfen
+ *
+ * Alle übrigen Versionen bleiben erhalten. Einträge hinter einem verworfenen
+ * Block rücken nach, ihre Vorgänger-Verweise zeigen dann ins Leere und sie
+ * werden zu Wurzeln im Undo-Baum.
+ */
+bool HistoryStore::load(const QString& path)
+{
+    if (!open(path)) return false;
+    if (decodeRange(activeBegin(), m_blocks.size())) return true;
+    return dropDamagedBlocks();
+}
+
+bool HistoryStore::dropDamagedBlocks()
+{
+    const QString reason = m_errorString;
+    const int current = currentIndex();
+    int newCurrent = current;
+    int visibleStart = 0;       // Index des ersten sichtbaren Eintrags im alten Stand
+    int lost = 0;
+    int firstChanged = -1;
+    qint64 skip = m_blocks.isEmpty() ? 0 : m_firstPosition - m_blocks.first().first;
+    qint64 position = m_blocks.isEmpty() ? 0 : m_blocks.first().first;
+    qint64 newSkip = 0;
+
+    QVector<Block> kept;
+    for (int b = 0; b < m_blocks.size(); ++b) {
+        Block& block = m_blocks[b];
+        const int visible = int(block.count - (b == 0 ? skip : 0));
+        if (block.damaged) {
+            if (current >= visibleStart + visible) {
+                newCurrent -= visible;
+            } else if (current >= visibleStart) {
+                newCurrent = visibleStart - lost - 1;  // Letzte Version davor
+            }
+            if (firstChanged < 0) firstChanged = kept.size();
+            lost += visible;
+            visibleStart += visible;
+            continue;
+        }
+        if (kept.isEmpty() && b == 0) newSkip = skip;
+        block.first = position;
+        position += block.count;
+        visibleStart += visible;
+        kept.append(block);
+    }
+    if (firstChanged < 0) return false;  // Fehler lag nicht an einem Block
+
+    m_blocks = kept;
+    m_firstPosition = m_blocks.isEmpty() ? 0 : m_blocks.first().first + newSkip;
+    m_size -= lost;
+    m_firstDirty = qMin(m_firstDirty, firstChanged);
+    setCurrentIndex(m_size == 0 ? -1 : qBound(0, newCurrent, m_size - 1));
+    m_repaired = true;
+    m_timesValid = false;
+    m_errorString = QString("%1, %2 Versionen in beschädigten Blöcken verworfen").arg(reason).arg(lost);
+    return true;
+}
+
+/**
+ * @brief Liest die Bytes nicht geladener Blöcke aus der Datei
+ */
+bool HistoryStore::readEncoded(int from, int to) const
+{
+    QFile file;
+    for (int b = from; b < to; ++b) {
+        Block& block = m_blocks[b];
+        if (block.dirty || !block.encoded.isEmpty() || block.offset < 0 || !block.shard.isEmpty()) continue;
+        if (!file.isOpen()) {
+            file.setFileName(m_path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                m_errorString = "Datei kann nicht geöffnet werden";
+                return false;
+            }
+        }
+        QReadLocker locker(&m_fileGuard->lock);
+        if (!blockUnchanged(block)) {
+            m_errorString = QString("Block %1 wurde inzwischen überschrieben").arg(b);
+            return false;
+        }
+        file.seek(block.offset);
+        block.encoded = file.read(block.diskSize);
+        if (block.encoded.size() != block.diskSize) {
+            block.encoded.clear();
+            m_errorString = QString("Block %1 ist unvollständig").arg(b);
+            return false;
+        }
+        if (m_fileVersion < 2) {
+            block.encoded = upgradeBlock(block.encoded);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Dekodiert alle noch nicht dekodierten Blöcke im Bereich parallel
+ */
+bool HistoryStore::decodeRange(int from, int to) const
+{
+    if (!readEncoded(from, to)) return false;
+
+    std::atomic<int> failedBlock(-1);
+    for (int b = from; b < to; ++b) {
+        // Abschnitte dekodieren ihre Blöcke selbst parallel
+        Block& block = m_blocks[b];
+        if (!block.decoded && !block.shard.isEmpty() && !loadShard(block)) {
+            block.damaged = true;
+            failedBlock = b;
+        }
+    }
+
+    Block* blocks = m_blocks.data();
+    parallelFor(to - from, [&](int i) {
+        Block& block = blocks[from + i];
+        if (block.decoded || !block.shard.isEmpty()) return;
+        QJsonArray entries;
+        qint64 textBytes = 0;
+        if (!decodeBlock(block.encoded, &entries, &textBytes) || entries.size() != block.count) {
+            block.damaged = true;
+            failedBlock = from + i;
+            return;
+        }
+        block.entries = entries;
+        block.textBytes = textBytes;
+        block.encoded.clear();
+        block.decoded = true;
+    });
+    if (failedBlock >= 0) {
+        m_errorString = QString("Block %1 ist beschädigt").arg(failedBlock.load());
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::encodeDirtyBlocks()
+{
+    QVector<int> dirty;
+    for (int b = m_firstDirty; b < m_blocks.size(); ++b) {
+        if (m_blocks[b].dirty && m_blocks[b].encoded.isEmpty() && m_blocks[b].shard.isEmpty()) dirty.append(b);
+    }
+    Block* blocks = m_blocks.data();
+    parallelFor(dirty.size(), [&](int i) {
+        Block& block = blocks[dirty[i]];
+        block.encoded = encodeBlock(block.entries, &block.textBytes);
+    });
+}
+
+QJsonObject HistoryStore::indexObject() const
+{
+    QJsonArray shardList;
+    QJsonArray blockList;
+    for (const Block& block : m_blocks) {
+        if (!block.shard.isEmpty()) {
+            shardList.append(QJsonArray{block.shard, block.count});
+        } else {
+            blockList.append(QJsonArray{block.offset, block.diskSize, block.count});
+        }
+    }
+    QJsonObject index;
+    if (!shardList.isEmpty()) index["shards"] = shardList;
+    index["blocks"] = blockList;
+    index["skip"] = m_blocks.isEmpty() ? 0 : int(m_firstPosition - m_blocks.first().first);
+    index["state"] = m_state;
+    if (m_timesValid) {
+        index["times"] = QString::fromLatin1(m_times.serialize().toBase64());
+    }
+    return index;
+}
+
+bool HistoryStore::save()
+{
+    if (m_backgroundJobs > 0) {
+        m_saveRequested = true;
+        return true;
+    }
+    return writeChanges();
+}
+
+bool HistoryStore::flush()
+{
+    m_saveRequested = false;
+    return writeChanges();
+}
+
+void HistoryStore::saveInBackground(QObject* context)
+{
+    struct Job {
+        qint64 first;
+        quint64 revision;
+        QJsonArray entries;     // Geteilte Kopie, der Store kann weiter geändert werden
+        QByteArray encoded;
+        qint64 textBytes;
+    };
+    auto jobs = std::make_shared<QVector<Job>>();
+    for (int b = m_firstDirty; b < m_blocks.size(); ++b) {
+        const Block& block = m_blocks[b];
+        if (block.dirty && block.encoded.isEmpty() && block.decoded && block.shard.isEmpty()) {
+            jobs->append({block.first, block.revision, block.entries, QByteArray(), 0});
+        }
+    }
+    if (jobs->isEmpty()) {
+        save();
+        return;
+    }
+
+    ++m_backgroundJobs;
+    m_saveRequested = true;
+    {
+        QMutexLocker locker(&m_background->mutex);
+        ++m_background->running;
+    }
+    const std::shared_ptr<Background> background = m_background;
+    QThreadPool::globalInstance()->start([this, jobs, context, background]() {
+        Job* data = jobs->data();
+        parallelFor(jobs->size(), [data](int i) {
+            data[i].encoded = encodeBlock(data[i].entries, &data[i].textBytes);
+        });
+
+        // Ergebnisse im Thread des Besitzers übernehmen. context lebt, bis
+        // waitForBackground() zurückkehrt; wird er danach zerstört, verfällt
+        // der Aufruf mit ihm.
+        QMetaObject::invokeMethod(context, [this, jobs]() {
+            for (Job& job : *jobs) {
+                auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), job.first,
+                                           [](const Block& block, qint64 value) { return block.first < value; });
+                if (it == m_blocks.end() || it->first != job.first) continue;
+                // Nur übernehmen, wenn der Block seitdem unverändert ist
+                if (it->dirty && it->encoded.isEmpty() && it->revision == job.revision) {
+                    it->encoded = job.encoded;
+                    it->textBytes = job.textBytes;
+                }
+            }
+            if (--m_backgroundJobs == 0 && m_saveRequested) {
+                m_saveRequested = false;
+                writeChanges();
+            }
+        }, Qt::QueuedConnection);
+
+        QMutexLocker locker(&background->mutex);
+        if (--background->running == 0) background->idle.wakeAll();
+    });
+}
+
+void HistoryStore::waitForBackground()
+{
+    QMutexLocker locker(&m_background->mutex);
+    while (m_background->running > 0) m_background->idle.wait(&m_background->mutex);
+}
+
+bool HistoryStore::writeChanges()
+{
+    if (m_path.isEmpty() || m_snapshot) return false;
+    keepDamagedCopy();
+
+    // Alte Blöcke in einen Abschnitt auslagern, Fehler verhindern das Speichern nicht
+    const int sealEnd = sealableEnd();
+    if (sealEnd > activeBegin() && !sealBlocks(sealEnd)) {
+        qDebug() << "Abschnitt konnte nicht ausgelagert werden:" << m_errorString;
+    }
+    if (!writeDirtyShards()) return false;
+    encodeDirtyBlocks();
+
+    // Datei komplett neu schreiben, wenn sie noch nicht im aktuellen
+    // Blockformat ist oder verworfene Blöcke mehr Platz belegen als die
+    // verbleibenden. Der freie Bereich hinter dem letzten unveränderten Block
+    // zählt nicht, er wird beim nächsten Speichern wiederverwendet.
+    const int begin = activeBegin();
+    qint64 liveBytes = 0;
+    for (int b = begin; b < m_blocks.size(); ++b) {
+        liveBytes += m_blocks[b].dirty ? m_blocks[b].encoded.size() : m_blocks[b].diskSize;
+    }
+    const qint64 unusedBytes = m_deadBytes - (m_spareEnd - m_spareStart);
+    if (!m_fileValid || m_fileVersion != FORMAT_VERSION || unusedBytes > liveBytes || !QFile::exists(m_path)) {
+        return rewrite();
+    }
+
+    // Unveränderte Blöcke hinter dem ersten geänderten werden mitverschoben
+    const int start = qMax(m_firstDirty, begin);
+    if (!readEncoded(start, m_blocks.size())) return false;
+
+    // Neuer Stand ab dem Ende des letzten unveränderten Blocks
+    qint64 gapStart = HEADER_SIZE;
+    if (start > begin) {
+        gapStart = m_blocks[start - 1].offset + m_blocks[start - 1].diskSize;
+    } else if (begin < m_blocks.size() && m_blocks[begin].offset >= 0) {
+        gapStart = m_blocks[begin].offset;
+    }
+    QByteArray data;
+    for (int b = start; b < m_blocks.size(); ++b) {
+        data.append(m_blocks[b].encoded);
+    }
+
+    // Nichts überschreiben, worauf der gespeicherte Index verweist: Passt der
+    // neue Stand samt Index in den beim letzten Speichern frei gewordenen
+    // Bereich, wird er dort geschrieben und die Datei danach gekürzt, sonst
+    // angehängt. Bis der neue Abschluss steht, bleibt der alte gültig.
+    const qint64 oldSize = m_fileSize;
+    QVector<qint64> oldOffsets;
+    QVector<qint64> oldSizes;
+    for (int b = start; b < m_blocks.size(); ++b) {
+        oldOffsets.append(m_blocks[b].offset);
+        oldSizes.append(m_blocks[b].diskSize);
+    }
+    const auto layout = [&](qint64 position) {
+        for (int b = start; b < m_blocks.size(); ++b) {
+            m_blocks[b].offset = position;
+            m_blocks[b].diskSize = m_blocks[b].encoded.size();
+            position += m_blocks[b].diskSize;
+        }
+        QByteArray index = encodeIndex(indexObject());
+        appendU64(index, quint64(position));
+        index.append(END_MAGIC, 4);
+        return index;
+    };
+    QByteArray tail = layout(gapStart);
+    const bool intoSpare = gapStart >= m_spareStart && gapStart + data.size() + tail.size() <= m_spareEnd;
+    const qint64 position = intoSpare ? gapStart : oldSize;
+    if (!intoSpare) tail = layout(position);
+
+    QWriteLocker locker(&m_fileGuard->lock);
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadWrite)) return false;
+    recordWrite(position);
+    const qint64 end = position + data.size() + tail.size();
+    const bool ok = file.seek(position) && file.write(data) == data.size() && file.write(tail) == tail.size()
+        && file.flush() && file.resize(end);
+    file.close();
+    if (!ok) {
+        // Der alte Index bleibt gültig, die Blöcke werden beim nächsten Mal erneut geschrieben
+        for (int b = start; b < m_blocks.size(); ++b) {
+            m_blocks[b].offset = oldOffsets[b - start];
+            m_blocks[b].diskSize = oldSizes[b - start];
+        }
+        m_spareStart = m_spareEnd = 0;
+        return false;
+    }
+
+    for (int b = start; b < m_blocks.size(); ++b) {
+        m_blocks[b].encoded.clear();
+        m_blocks[b].dirty = false;
+    }
+    m_fileSize = end;
+    m_spareStart = intoSpare ? 0 : gapStart;
+    m_spareEnd = intoSpare ? 0 : oldSize;
+
+    m_firstDirty = m_blocks.size();
+    m_deadBytes = end - tail.size() - HEADER_SIZE;
+    for (int b = begin; b < m_blocks.size(); ++b) {
+        m_deadBytes -= m_blocks[b].diskSize;
+    }
+    removeDeadShards();
+    return true;
+}
+
+bool HistoryStore::compact()
+{
+    if (m_path.isEmpty() || m_snapshot) return false;
+    if (!writeDirtyShards()) return false;
+    encodeDirtyBlocks();
+    keepDamagedCopy();
+    return rewrite();
+}
+
+/**
+ * @brief Hebt eine beschädigte Datei vor dem ersten Überschreiben auf
+ */
+void HistoryStore::keepDamagedCopy()
+{
+    if (!m_repaired) return;
+    QFile::remove(m_path + ".damaged");
+    QFile::copy(m_path, m_path + ".damaged");
+    m_repaired = false;
+}
+
+/**
+ * @brief Schreibt die Datei über eine temporäre Datei komplett neu
+ *
+ * Unveränderte Blöcke werden einzeln aus der alten Datei kopiert, ohne sie
+ * zu dekodieren.
+ */
+bool HistoryStore::rewrite()
+{
+    QFile in(m_path);
+    const bool haveOld = m_fileValid && in.open(QIODevice::ReadOnly);
+
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly)) return false;
+
+    QByteArray header(FILE_MAGIC, 4);
+    appendU32(header, FORMAT_VERSION);
+    bool ok = out.write(header) == header.size();
+
+    QVector<qint64> oldOffsets(m_blocks.size());
+    QVector<qint64> oldSizes(m_blocks.size());
+    int processed = 0;
+    qint64 position = HEADER_SIZE;
+    for (int b = 0; b < m_blocks.size() && ok; ++b) {
+        Block& block = m_blocks[b];
+        oldOffsets[b] = block.offset;
+        oldSizes[b] = block.diskSize;
+        ++processed;
+        if (!block.shard.isEmpty()) continue;  // Liegt in der eigenen Datei
+
+        QByteArray bytes = block.encoded;
+        if (bytes.isEmpty() && haveOld && block.offset >= 0) {
+            in.seek(block.offset);
+            bytes = in.read(block.diskSize);
+            if (bytes.size() != block.diskSize) bytes.clear();
+            if (m_fileVersion < 2) bytes = upgradeBlock(bytes);
+        }
+        if (bytes.isEmpty()) {
+            if (!block.decoded) {
+                m_errorString = QString("Block %1 ist unvollständig").arg(b);
+                ok = false;
+                break;
+            }
+            bytes = encodeBlock(block.entries);
+        }
+        block.offset = position;
+        block.diskSize = bytes.size();
+        ok = out.write(bytes) == bytes.size();
+        position += bytes.size();
+    }
+    in.close();
+
+    if (ok) {
+        QByteArray tail = encodeIndex(indexObject());
+        appendU64(tail, quint64(position));
+        tail.append(END_MAGIC, 4);
+        ok = out.write(tail) == tail.size();
+        if (ok) {
+            // Alle Blöcke liegen danach an neuen Stellen
+            QWriteLocker locker(&m_fileGuard->lock);
+            ok = out.commit();
+            if (ok) recordWrite(0);
+        }
+        position += tail.size();
+    } else {
+        out.cancelWriting();
+    }
+
+    if (!ok) {
+        // Alte Positionen bleiben gültig
+        for (int b = 0; b < processed; ++b) {
+            m_blocks[b].offset = oldOffsets[b];
+            m_blocks[b].diskSize = oldSizes[b];
+        }
+        return false;
+    }
+
+    for (Block& block : m_blocks) {
+        block.encoded.clear();
+        block.dirty = false;
+    }
+    m_firstDirty = m_blocks.size();
+    m_fileValid = true;
+    m_fileVersion = FORMAT_VERSION;
+    m_deadBytes = 0;
+    m_fileSize = position;
+    m_spareStart = m_spareEnd = 0;
+    removeDeadShards();
+    return true;
+}
+
+bool HistoryStore::verify(const QString& path, QString* error)
+{
+    HistoryStore store;
+    if (!store.open(path) || store.wasRepaired()) {
+        if (error) *error = store.errorString();
+        return false;
+    }
+
+    // Stapelweise dekodieren, damit große Dateien nicht komplett im Speicher liegen
+    const int batch = qMax(1, QThread::idealThreadCount()) * 2;
+    for (int from = 0; from < store.blockCount(); from += batch) {
+        if (!store.decodeRange(from, qMin(from + batch, store.blockCount()))) {
+            if (error) *error = store.errorString();
+            return false;
+        }
+        store.releaseCache();
+    }
+    return true;
+}
+
+bool HistoryStore::verifyChecksums(const QString& path, QString* error)
+{
+    HistoryStore store;
+    if (!store.open(path) || store.wasRepaired()) {
+        if (error) *error = store.errorString();
+        return false;
+    }
+
+    // Nur lesen und Prüfsummen vergleichen, stapelweise wie verify()
+    const int batch = qMax(1, QThread::idealThreadCount()) * 2;
+    for (int from = 0; from < store.blockCount(); from += batch) {
+        const int to = qMin(from + batch, store.blockCount());
+        if (!store.readEncoded(from, to)) {
+            if (error) *error = store.errorString();
+            return false;
+        }
+        for (int b = from; b < to; ++b) {
+            const Block& block = store.m_blocks[b];
+            if (!block.shard.isEmpty()) {
+                if (!block.decoded && !verifyChecksums(store.shardPath(block.shard), error)) return false;
+                continue;
+            }
+            if (!block.decoded && !blockIntact(block.encoded)) {
+                if (error) *error = QString("Block %1 ist beschädigt").arg(b);
+                return false;
+            }
+        }
+        store.releaseCache();
+    }
+    return true;
+}
+
+int HistoryStore::blockOf(int index) const
+{
+    const qint64 position = m_firstPosition + index;
+    auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), position,
+                               [](qint64 value, const Block& block) { return value < block.first; });
+    return int(it - m_blocks.cbegin()) - 1;
+}
+
+void HistoryStore::markDirty(int block)
+{
+    m_blocks[block].encoded.clear();
+    m_blocks[block].dirty = true;
+    m_blocks[block].revision = ++m_revision;
+    m_firstDirty = qMin(m_firstDirty, block);
+}
+
+int HistoryStore::activeBegin() const
+{
+    // Abschnitte liegen immer am Anfang
+    int b = 0;
+    while (b < m_blocks.size() && !m_blocks[b].shard.isEmpty()) ++b;
+    return b;
+}
+
+int HistoryStore::shardCount() const
+{
+    return activeBegin();
+}
+
+QString HistoryStore::shardPath(const QString& name) const
+{
+    return QFileInfo(m_path).dir().filePath(name);
+}
+
+/**
+ * @brief Freier Name für einen Abschnitt, benannt nach dem Monat seiner ersten Version
+ */
+QString HistoryStore::newShardName(qint64 firstTime) const
+{
+    const QString month = firstTime > 0 ? QDateTime::fromMSecsSinceEpoch(firstTime).toString("yyyy-MM") : QString("0000-00");
+    const QString base = QFileInfo(m_path).fileName();
+    for (int n = 1;; ++n) {
+        const QString name = QString("%1.%2.%3.shard").arg(base, month).arg(n, 2, 10, QChar('0'));
+        if (!QFile::exists(shardPath(name)) && !m_deadShards.contains(name)) return name;
+    }
+}
+
+/**
+ * @brief Liest alle Einträge einer Abschnittsdatei in den Platzhalter-Block
+ */
+bool HistoryStore::loadShard(Block& block) const
+{
+    HistoryStore shard;
+    if (!shard.load(shardPath(block.shard)) || shard.wasRepaired()) {
+        m_errorString = QString("Abschnitt %1: %2").arg(block.shard, shard.errorString());
+        return false;
+    }
+    if (shard.size() != block.count) {
+        m_errorString = QString("Abschnitt %1 hat %2 statt %3 Einträge").arg(block.shard).arg(shard.size()).arg(block.count);
+        return false;
+    }
+    QJsonArray entries;
+    shard.forEach([&entries](int, const QJsonObject& entry) {
+        entries.append(entry);
+        return true;
+    });
+    block.entries = entries;
+    block.textBytes = textBytesOf(entries);
+    block.decoded = true;
+    return true;
+}
+
+/**
+ * @brief Ende der Blöcke, die beim nächsten Speichern ausgelagert werden sollen
+ *
+ * Der letzte Block wird noch erweitert und bleibt immer in der aktiven Datei.
+ * Ist die Datei zu groß, werden alle übrigen ausgelagert, sonst die Blöcke,
+ * deren letzte Version vor dem Monat liegt, der SHARD_DELAY_DAYS zurückliegt.
+ * Im Normalfall kostet die Prüfung nur einen Blick auf den ersten Block.
+ */
+int HistoryStore::sealableEnd() const
+{
+    const int begin = activeBegin();
+    const int closed = m_blocks.size() - 1;
+    if (closed <= begin) return begin;
+    if (m_fileSize > SHARD_BYTES) return closed;
+    if (!m_timesValid) return begin;  // Ohne Zeitindex nicht alle Blöcke lesen
+
+    const QDate cutoffDay = QDate::currentDate().addDays(-SHARD_DELAY_DAYS);
+    const qint64 cutoff = QDate(cutoffDay.year(), cutoffDay.month(), 1).startOfDay().toMSecsSinceEpoch();
+    int end = begin;
+    while (end < closed) {
+        const Block& block = m_blocks[end];
+        const qint64 last = block.first + block.count - 1 - m_firstPosition;
+        const qint64 time = last >= 0 ? m_times.at(int(last)) : 0;
+        if (time <= 0 || time >= cutoff) break;
+        ++end;
+    }
+    return end;
+}
+
+/**
+ * @brief Schreibt Einträge als eigene Datei im Blockformat mit ihren Verweisen im Index
+ */
+bool HistoryStore::writeShard(const QString& path, const QJsonArray& entries)
+{
+    HistoryStore shard;
+    shard.m_path = path;
+    QJsonArray links;
+    for (const QJsonValue& value : entries) {
+        const QJsonObject entry = value.toObject();
+        shard.append(entry);
+        links.append(linksOf(entry));
+    }
+    shard.m_state["links"] = links;
+    shard.encodeDirtyBlocks();
+    return shard.rewrite();
+}
+
+/**
+ * @brief Lagert die Blöcke von activeBegin() bis end in eine neue Abschnittsdatei aus
+ *
+ * Zuerst wird der Abschnitt geschrieben, erst das folgende Speichern der
+ * aktiven Datei verweist darauf. Bricht es ab, bleiben die Blöcke in der
+ * aktiven Datei und der Abschnitt ist nur überzählig.
+ */
+bool HistoryStore::sealBlocks(int end)
+{
+    const int begin = activeBegin();
+    if (end <= begin) return true;
+    if (!decodeRange(begin, end)) return false;
+
+    QJsonArray entries;
+    for (int b = begin; b < end; ++b) {
+        for (const QJsonValue& value : m_blocks[b].entries) entries.append(value);
+    }
+    const QString name = newShardName(entries.first().toObject()["time"].toInteger());
+    if (!writeShard(shardPath(name), entries)) {
+        m_errorString = QString("Abschnitt %1 konnte nicht geschrieben werden").arg(name);
+        return false;
+    }
+
+    Block shard;
+    shard.shard = name;
+    shard.first = m_blocks[begin].first;
+    shard.count = entries.size();
+    shard.decoded = false;
+    shard.dirty = false;
+    shard.revision = ++m_revision;
+    for (int b = begin; b < end; ++b) {
+        if (m_blocks[b].offset >= 0) m_deadBytes += m_blocks[b].diskSize;
+    }
+    m_blocks.remove(begin, end - begin);
+    m_blocks.insert(begin, shard);
+    if (m_firstDirty >= end) {
+        m_firstDirty -= end - begin - 1;
+    } else if (m_firstDirty >= begin) {
+        m_firstDirty = begin + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Schreibt Abschnitte neu, in denen Einträge entfernt oder ersetzt wurden
+ */
+bool HistoryStore::writeDirtyShards()
+{
+    const int begin = activeBegin();
+    for (int b = 0; b < begin; ++b) {
+        Block& block = m_blocks[b];
+        if (!block.dirty) continue;
+        if (!writeShard(shardPath(block.shard), block.entries)) {
+            m_errorString = QString("Abschnitt %1 konnte nicht geschrieben werden").arg(block.shard);
+            return false;
+        }
+        block.dirty = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Merkt die Datei eines entfernten Abschnitts zum Löschen vor
+ *
+ * Gelöscht wird erst, wenn der Index ohne den Abschnitt geschrieben ist.
+ */
+void HistoryStore::dropShard(const Block& block)
+{
+    if (!block.shard.isEmpty() && !m_snapshot) m_deadShards.append(block.shard);
+}
+
+void HistoryStore::removeDeadShards()
+{
+    for (const QString& name : m_deadShards) QFile::remove(shardPath(name));
+    m_deadShards.clear();
+}
+
+QJsonObject HistoryStore::entry(int index) const
+{
+    if (index < 0 || index >= m_size) return QJsonObject();
+    const int b = blockOf(index);
+    if (!m_blocks[b].decoded && !decodeRange(b, b + 1)) return QJsonObject();
+    const Block& block = m_blocks[b];
+    return block.entries[int(m_firstPosition + index - block.first)].toObject();
+}
+
+void HistoryStore::prefetch(int first, int last) const
+{
+    first = qMax(0, first);
+    last = qMin(m_size - 1, last);
+    if (first > last) return;
+    decodeRange(blockOf(first), blockOf(last) + 1);
+}
+
+void HistoryStore::forEach(const std::function<bool(int index, const QJsonObject& entry)>& fn) const
+{
+    for (int b = 0; b < m_blocks.size(); ++b) {
+        const bool wasDecoded = m_blocks[b].decoded;
+        if (!wasDecoded && !decodeRange(b, b + 1)) continue;
+
+        Block& block = m_blocks[b];
+        bool proceed = true;
+        for (int k = 0; k < block.count && proceed; ++k) {
+            const qint64 position = block.first + k;
+            if (position < m_firstPosition) continue;
+            proceed = fn(int(position - m_firstPosition), block.entries[k].toObject());
+        }
+        if (!wasDecoded) {
+            block.entries = QJsonArray();
+            block.decoded = false;
+        }
+        if (!proceed) return;
+    }
+}
+
+void HistoryStore::forEachLinks(const std::function<bool(int index, const QJsonObject& entry)>& fn) const
+{
+    for (int b = 0; b < m_blocks.size(); ++b) {
+        QJsonArray links;
+        if (!m_blocks[b].shard.isEmpty() && !m_blocks[b].decoded) {
+            // Nur den Index des Abschnitts lesen
+            HistoryStore shard;
+            if (shard.open(shardPath(m_blocks[b].shard))) links = shard.m_state["links"].toArray();
+        }
+
+        // Sonst wie forEach() die Einträge selbst verwenden
+        const bool useLinks = !links.isEmpty() && links.size() == m_blocks[b].count;
+        const bool wasDecoded = m_blocks[b].decoded;
+        if (!useLinks && !wasDecoded && !decodeRange(b, b + 1)) continue;
+
+        Block& block = m_blocks[b];
+        const QJsonArray& source = useLinks ? links : block.entries;
+        bool proceed = true;
+        for (int k = 0; k < block.count && proceed; ++k) {
+            const qint64 position = block.first + k;
+            if (position < m_firstPosition) continue;
+            proceed = fn(int(position - m_firstPosition), source[k].toObject());
+        }
+        if (!useLinks && !wasDecoded) {
+            block.entries = QJsonArray();
+            block.decoded = false;
+        }
+        if (!proceed) return;
+    }
+}
+
+void HistoryStore::append(const QJsonObject& entry)
+{
+    // Der letzte Block muss dekodiert sein und in der aktiven Datei liegen, um erweitert zu werden
+    bool startBlock = m_blocks.isEmpty() || !m_blocks.last().shard.isEmpty();
+    if (!startBlock && !m_blocks.last().decoded) {
+        startBlock = !decodeRange(m_blocks.size() - 1, m_blocks.size());
+    }
+
+    // Vollen Block abschließen und einen neuen beginnen
+    if (startBlock || m_blocks.last().count >= BLOCK_ENTRIES
+        || m_blocks.last().textBytes >= BLOCK_TEXT_BYTES) {
+        Block block;
+        block.first = m_firstPosition + m_size;
+        m_blocks.append(block);
+    }
+    Block& last = m_blocks.last();
+    last.textBytes += textCost(entry["text"].toString(), last.entries.isEmpty());
+    last.entries.append(entry);
+    last.count++;
+    markDirty(m_blocks.size() - 1);
+    ++m_size;
+    if (m_timesValid) m_times.append(entry["time"].toInteger());
+}
+
+void HistoryStore::truncate(int size)
+{
+    size = qMax(0, size);
+    if (m_timesValid) m_times.truncate(size);
+    while (m_size > size) {
+        Block& last = m_blocks.last();
+        const qint64 available = last.first + last.count - qMax(last.first, m_firstPosition);
+        const qint64 excess = m_size - size;
+        if (excess >= available || (!last.decoded && !decodeRange(m_blocks.size() - 1, m_blocks.size()))) {
+            dropShard(last);
+            m_blocks.removeLast();
+            m_size -= int(available);
+            m_firstDirty = qMin(m_firstDirty, int(m_blocks.size()));
+        } else {
+            for (qint64 i = 0; i < excess; ++i) last.entries.removeLast();
+            last.count -= int(excess);
+            last.textBytes = textBytesOf(last.entries);
+            m_size = size;
+            markDirty(m_blocks.size() - 1);
+        }
+    }
+    if (m_times.size() != m_size) m_timesValid = false;  // Nicht lesbarer Block wurde ganz entfernt
+}
+
+void HistoryStore::removeFirst()
+{
+    if (m_size == 0) return;
+    ++m_firstPosition;
+    --m_size;
+    if (m_timesValid) m_times.removeFirst();
+
+    // Vollständig übersprungene Blöcke verwerfen, der Platz wird beim Neuschreiben frei
+    const Block& first = m_blocks.first();
+    if (m_firstPosition >= first.first + first.count) {
+        if (first.offset >= 0) m_deadBytes += first.diskSize;
+        dropShard(first);
+        m_blocks.removeFirst();
+        if (m_firstDirty > 0) --m_firstDirty;
+    }
+}
+
+void HistoryStore::removeEntries(const QList<int>& indices)
+{
+    if (indices.isEmpty() || indices.first() < 0) return;
+    if (m_timesValid) m_times.remove(indices);
+
+    int k = 0;
+    qint64 removedBefore = 0;
+    int b = blockOf(indices.first());
+    while (b < m_blocks.size()) {
+        Block& block = m_blocks[b];
+        const qint64 originalFirst = block.first;
+        block.first -= removedBefore;
+
+        // Einträge dieses Blocks entfernen, Indizes beziehen sich auf den alten Stand
+        int removedHere = 0;
+        while (k < indices.size() && m_firstPosition + indices[k] < originalFirst + block.count + removedHere) {
+            if (indices[k] >= m_size || m_firstPosition + indices[k] < originalFirst
+                || (!block.decoded && !decodeRange(b, b + 1))) {
+                ++k;
+                continue;
+            }
+            block.entries.removeAt(int(m_firstPosition + indices[k] - originalFirst) - removedHere);
+            block.count--;
+            ++removedHere;
+            ++k;
+        }
+        if (removedHere > 0) {
+            removedBefore += removedHere;
+            block.textBytes = textBytesOf(block.entries);
+            markDirty(b);
+        }
+        if (block.count == 0) {
+            dropShard(block);
+            m_blocks.removeAt(b);
+            m_firstDirty = qMin(m_firstDirty, b);
+            continue;
+        }
+        ++b;
+    }
+    m_size -= int(removedBefore);
+    if (m_times.size() != m_size) m_timesValid = false;  // Nicht lesbare Einträge wurden übergangen
+}
+
+void HistoryStore::replaceEntry(int index, const QJsonObject& entry)
+{
+    if (index < 0 || index >= m_size) return;
+    const int b = blockOf(index);
+    if (!m_blocks[b].decoded && !decodeRange(b, b + 1)) return;
+
+    Block& block = m_blocks[b];
+    block.entries[int(m_firstPosition + index - block.first)] = entry;
+    block.textBytes = textBytesOf(block.entries);
+    markDirty(b);
+    if (m_timesValid) m_times.replace(index, entry["time"].toInteger());
+}
+
+void HistoryStore::clear()
+{
+    for (const Block& block : m_blocks) dropShard(block);
+    m_blocks.clear();
+    m_firstPosition = 0;
+    m_size = 0;
+    m_firstDirty = 0;
+    m_fileValid = false;
+    m_deadBytes = 0;
+    m_spareStart = m_spareEnd = 0;
+    m_state = QJsonObject();
+    m_repaired = false;
+    m_times.clear();
+    m_timesValid = true;
+}
+
+void HistoryStore::releaseCache()
+{
+    for (Block& block : m_blocks) {
+        if (block.dirty || (block.offset < 0 && block.shard.isEmpty())) continue;
+        block.entries = QJsonArray();
+        block.encoded.clear();
+        block.decoded = false;
+    }
+}
+
+int HistoryStore::currentIndex() const
+{
+    return m_state["currentIndex"].toInt(-1);
+}
+
+void HistoryStore::setCurrentIndex(int index)
+{
+    m_state["currentIndex"] = index;
+}
+
+/**
+ * @brief Baut den Zeitindex aus den Einträgen auf, falls die Datei keinen hatte
+ */
+bool HistoryStore::ensureTimes() const
+{
+    if (m_timesValid) return true;
+    TimeIndex times;
+    forEachLinks([&times](int, const QJsonObject& entry) {
+        times.append(entry["time"].toInteger());
+        return true;
+    });
+    if (times.size() != m_size) return false;  // Nicht lesbare Blöcke
+    m_times = times;
+    m_timesValid = true;
+    return true;
+}
+
+int HistoryStore::versionAt(qint64 msecs) const
+{
+    if (!ensureTimes()) return -1;
+    return m_times.atOrBefore(msecs);
+}
+
+qint64 HistoryStore::timeOf(int index) const
+{
+    if (!ensureTimes()) return 0;
+    return m_times.at(index);
+}
+
+QList<int> HistoryStore::search(const QString& text, Qt::CaseSensitivity cs) const
+{
+    decodeRange(0, m_blocks.size());
+
+    QVector<QList<int>> matches(m_blocks.size());
+    QList<int>* blockMatches = matches.data();
+    const Block* blocks = m_blocks.constData();
+    parallelFor(m_blocks.size(), [&](int b) {
+        const Block& block = blocks[b];
+        if (!block.decoded) return;
+        for (int k = 0; k < block.count; ++k) {
+            const qint64 position = block.first + k;
+            if (position < m_firstPosition) continue;
+            if (block.entries[k].toObject()["text"].toString().contains(text, cs)) {
+                blockMatches[b].append(int(position - m_firstPosition));
+            }
+        }
+    });
+
+    QList<int> result;
+    for (const QList<int>& found : matches) result.append(found);
+    return result;
+}
@@ -0,0 +1,399 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVector>
+#include <QList>
+#include <QStringList>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QWaitCondition>
+#include "timeindex.h"
+#include <functional>
+#include <memory>
+
+class QObject;
+class QFile;
+
+/**
+ * @brief Komprimiert Daten mit zlib im gzip-Format
+ */
+QByteArray compressData(const QByteArray& data);
+
+/**
+ * @brief Dekomprimiert gzip-komprimierte Daten
+ */
+QByteArray decompressData(const QByteArray& data);
+
+/**
+ * @brief Blockweise komprimierter Speicher für die History
+ *
+ * Dateiformat (Zahlen little-endian):
+ *   Kopf:      "QNHB" | u32 Formatversion
+ *   Block:     "QNBK" | u32 Länge der Nutzdaten | u32 Anzahl Einträge | u32 CRC32C | gzip(JSON-Array)
+ *   Index:     "QNIX" | u32 Länge der Nutzdaten | gzip(JSON mit Blockliste und Zustand)
+ *   Abschluss: u64 Position des Index | "QNHE"
+ *
+ * Jeder Block lässt sich unabhängig dekomprimieren (ähnlich BGZF), dadurch
+ * werden Laden, Prüfen und Suchen auf alle Kerne verteilt. Beim Speichern
+ * werden nur geänderte Blöcke neu komprimiert und ab dem ersten geänderten
+ * Block samt neuem Index hinter den bisherigen Index geschrieben, oder in
+ * den beim vorigen Speichern frei gewordenen Bereich, wenn sie dort
+ * hineinpassen; dann wird die Datei danach gekürzt. Worauf der gültige
+ * Index verweist, wird so nie überschrieben. Bricht das Anhängen ab, gilt
+ * beim Laden der letzte vollständige Abschluss. Alte, monolithische
+ * gzip-Dateien werden weiterhin gelesen und beim nächsten Speichern
+ * umgewandelt.
+ *
+ * Steht der Text eines Eintrags schon weiter vorn im selben Block, etwa
+ * nach Tippen und Löschen eines Zeichens, enthält der Eintrag auf der
+ * Festplatte ab Formatversion 3 statt "text" nur "same" mit der Position
+ * des gleichen Eintrags im Block. Beim Dekodieren wird der Text wieder
+ * eingesetzt, außerhalb von encodeBlock() und decodeBlock() sind Einträge
+ * immer vollständig.
+ *
+ * Ab Formatversion 4 werden Texte ab 16 KB als Differenz zum vorherigen
+ * Eintrag desselben Blocks abgelegt ("delta" und "bytes", siehe
+ * DeltaCodec). Der erste Eintrag jedes Blocks ist vollständig und dient
+ * als Schlüsselbild, ein Block bleibt damit für sich dekodierbar. Bei
+ * großen Notizen folgen ihm unabhängig von ihrer Länge bis zu 16
+ * Differenzen. Kleinere Texte erkennt gzip im Block ohnehin beim Vorgänger.
+ *
+ * Die Prüfsumme deckt Länge, Anzahl und Nutzdaten ab und wird vor dem
+ * Dekomprimieren verglichen. Blöcke der Formatversion 1 haben noch keine,
+ * sie wird beim Lesen ergänzt. Fehlt der Index, etwa nach einem
+ * abgebrochenen Schreibvorgang, werden alle intakten Blöcke durch Suchen in
+ * der Datei wiederhergestellt; beschädigte Blöcke werden von load()
+ * verworfen, statt die ganze History aufzugeben.
+ *
+ * Ältere Blöcke werden in abgeschlossene Abschnittsdateien neben der
+ * History ausgelagert (<Datei>.<Jahr-Monat>.<Nr>.shard, selbst im
+ * Blockformat), sobald ihr Monat eine Woche vorbei ist oder die aktive
+ * Datei SHARD_BYTES überschreitet. Der Index der aktiven Datei führt sie
+ * nur mit Namen und Anzahl Einträge. Beim Tippen wird nur die aktive Datei
+ * geschrieben; ein Abschnitt wird erst gelesen, wenn auf einen seiner
+ * Einträge zugegriffen wird, und nur neu geschrieben, wenn Einträge darin
+ * entfernt oder ersetzt werden. Für den Undo-Baum stehen Kennung,
+ * Vorgänger und Zeitpunkt aller Einträge zusätzlich im Index des
+ * Abschnitts, siehe forEachLinks().
+ *
+ * Der Index enthält zusätzlich die Zeitpunkte aller Versionen als TimeIndex,
+ * damit versionAt() ohne Dekodieren von Blöcken antworten kann. Fehlt er,
+ * etwa in älteren Dateien, wird er beim ersten Zugriff einmal aus den
+ * Einträgen aufgebaut.
+ *
+ * Mit snapshot() entsteht eine unveränderliche Kopie, die in einem anderen
+ * Thread gelesen werden kann, während der Store weiter geändert und
+ * gespeichert wird.
+ *
+ * Die Klasse hängt nur von QtCore und zlib ab und wird auch vom
+ * Kommandozeilenwerkzeug quicknote-history verwendet.
+ */
+class HistoryStore
+{
+public:
+    static const int BLOCK_ENTRIES = 64;        // Maximale Einträge pro Block
+    static const int BLOCK_TEXT_BYTES = 1 << 20; // Block wird ab dieser Textmenge abgeschlossen, große Texte pauschal
+    static const qint64 SHARD_BYTES = 32 << 20; // Aktive Datei wird ab dieser Größe ausgelagert
+    static const int SHARD_DELAY_DAYS = 7;      // Ein Monat wird so viele Tage nach seinem Ende ausgelagert
+
+    HistoryStore();
+
+    /**
+     * @brief Öffnet eine History-Datei, liest aber nur den Index
+     *
+     * Blöcke werden erst beim Zugriff gelesen und dekodiert.
+     * @param path Pfad der History-Datei, wird auch für save() verwendet
+     * @return true wenn die Datei gelesen werden konnte
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Öffnet eine History-Datei und dekomprimiert alle Blöcke der aktiven Datei parallel
+     *
+     * Abgeschlossene Abschnitte werden wie bei open() erst beim Zugriff gelesen.
+     * @param path Pfad der History-Datei, wird auch für save() verwendet
+     * @return true wenn die Datei vollständig gelesen werden konnte
+     */
+    bool load(const QString& path);
+
+    /**
+     * @brief Schreibt geänderte Blöcke, den Index und den Zustand
+     *
+     * Läuft noch eine Komprimierung aus saveInBackground(), wird das
+     * Speichern nur vorgemerkt und danach nachgeholt.
+     * @return true bei Erfolg
+     */
+    bool save();
+
+    /**
+     * @brief Komprimiert geänderte Blöcke im Thread-Pool und speichert danach
+     *
+     * Die Ergebnisse werden im Thread von context übernommen, context muss
+     * den Store besitzen oder überleben und vor seiner Zerstörung
+     * waitForBackground() aufrufen. Blöcke, die sich zwischenzeitlich
+     * geändert haben, werden beim Speichern wie üblich komprimiert.
+     */
+    void saveInBackground(QObject* context);
+
+    /**
+     * @brief Wartet, bis keine Komprimierung aus saveInBackground() mehr im Thread-Pool läuft
+     *
+     * Noch nicht übernommene Ergebnisse verfallen mit context, flush()
+     * komprimiert die Blöcke dann selbst.
+     */
+    void waitForBackground();
+
+    /**
+     * @brief Speichert sofort, auch wenn noch eine Komprimierung im Hintergrund läuft
+     */
+    bool flush();
+
+    /**
+     * @brief Schreibt die Datei vollständig neu und gibt ungenutzten Platz frei
+     * @return true bei Erfolg
+     */
+    bool compact();
+
+    /**
+     * @brief Prüft eine Datei auf der Festplatte vollständig
+     *
+     * Die Blöcke werden stapelweise parallel dekodiert, der Speicherbedarf
+     * bleibt dabei begrenzt.
+     * @param path Pfad der zu prüfenden Datei
+     * @param error Erhält eine Fehlerbeschreibung, falls die Prüfung fehlschlägt
+     * @return true wenn alle Blöcke lesbar sind
+     */
+    static bool verify(const QString& path, QString* error = nullptr);
+
+    /**
+     * @brief Vergleicht nur die Prüfsummen aller Blöcke, ohne zu dekomprimieren
+     */
+    static bool verifyChecksums(const QString& path, QString* error = nullptr);
+
+    /**
+     * @brief Liefert eine Kopie zum Lesen aus einem anderen Thread
+     *
+     * Dekodierte Blöcke werden geteilt, fehlende liest die Kopie selbst aus
+     * der Datei. Hat der Store die Stelle eines Blocks inzwischen
+     * überschrieben, schlägt das Lesen fehl, statt einen anderen Block zu
+     * liefern. Die Kopie kann nicht gespeichert werden.
+     */
+    HistoryStore snapshot() const;
+    bool isSnapshot() const { return m_snapshot; }
+
+    /**
+     * @brief true wenn beim Öffnen oder Laden beschädigte Teile übergangen wurden
+     *
+     * errorString() beschreibt dann, was wiederhergestellt wurde. Der Store
+     * ist trotzdem benutzbar. Das nächste Speichern legt eine Kopie der
+     * beschädigten Datei mit der Endung .damaged an und schreibt eine
+     * bereinigte Datei.
+     */
+    bool wasRepaired() const { return m_repaired; }
+
+    QString path() const { return m_path; }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    int blockCount() const { return m_blocks.size(); }
+
+    /**
+     * @brief Anzahl abgeschlossener Abschnittsdateien
+     */
+    int shardCount() const;
+
+    /**
+     * @brief Größe der Datei nach dem letzten Lesen oder Schreiben
+     */
+    qint64 fileSize() const { return m_fileSize; }
+
+    /**
+     * @brief Ungenutzte Bytes in der Datei, die compact() freigeben würde
+     */
+    qint64 deadBytes() const { return m_deadBytes; }
+
+    /**
+     * @brief Beschreibung des letzten Fehlers beim Lesen
+     */
+    QString errorString() const { return m_errorString; }
+
+    /**
+     * @brief Liefert den Eintrag mit dem angegebenen Index
+     */
+    QJsonObject entry(int index) const;
+
+    /**
+     * @brief Ruft fn für alle Einträge der Reihe nach auf
+     *
+     * Nicht geladene Blöcke werden nur für die Dauer ihres Durchlaufs im
+     * Speicher gehalten. Liefert fn false, wird abgebrochen.
+     */
+    void forEach(const std::function<bool(int index, const QJsonObject& entry)>& fn) const;
+
+    /**
+     * @brief Wie forEach(), aber für abgeschlossene Abschnitte nur mit Kennung, Vorgänger und Zeitpunkt
+     *
+     * Die Verweise stehen im Index der Abschnittsdatei, deren Blöcke werden
+     * dafür nicht dekodiert. Reicht zum Aufbau des Undo-Baums.
+     */
+    void forEachLinks(const std::function<bool(int index, const QJsonObject& entry)>& fn) const;
+
+    /**
+     * @brief Dekodiert die Blöcke der Einträge first bis last im Voraus parallel
+     *
+     * Indizes außerhalb der History werden ignoriert.
+     */
+    void prefetch(int first, int last) const;
+
+    void append(const QJsonObject& entry);
+
+    /**
+     * @brief Entfernt alle Einträge ab dem angegebenen Index
+     */
+    void truncate(int size);
+
+    /**
+     * @brief Entfernt den ältesten Eintrag
+     */
+    void removeFirst();
+
+    /**
+     * @brief Entfernt beliebige Einträge
+     *
+     * Betroffene Blöcke werden neu komprimiert, beim nächsten Speichern wird
+     * die Datei ab dem ersten betroffenen Block neu geschrieben.
+     * @param indices Aufsteigend sortierte Indizes
+     */
+    void removeEntries(const QList<int>& indices);
+
+    /**
+     * @brief Ersetzt einen vorhandenen Eintrag
+     */
+    void replaceEntry(int index, const QJsonObject& entry);
+
+    void clear();
+
+    /**
+     * @brief Gibt dekodierte Blöcke frei, die unverändert auf der Festplatte liegen
+     */
+    void releaseCache();
+
+    int currentIndex() const;
+    void setCurrentIndex(int index);
+
+    /**
+     * @brief Letzte Version, die zum angegebenen Zeitpunkt schon existierte
+     * @param msecs Zeitpunkt in ms seit 1970
+     * @return Index der Version oder -1, wenn es damals noch keine gab
+     */
+    int versionAt(qint64 msecs) const;
+
+    /**
+     * @brief Zeitpunkt einer Version in ms seit 1970, 0 wenn unbekannt
+     */
+    qint64 timeOf(int index) const;
+
+    /**
+     * @brief Sucht parallel in allen Versionen nach einem Text
+     * @return Aufsteigend sortierte Indizes der Versionen, die den Text enthalten
+     */
+    QList<int> search(const QString& text, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+private:
+    struct Block {
+        QJsonArray entries;     // Dekodierte Einträge, nur gültig wenn decoded
+        QByteArray encoded;     // Block wie auf der Festplatte, nur solange benötigt
+        QString shard;          // Name der Abschnittsdatei, leer wenn der Block in der aktiven Datei liegt
+        qint64 offset = -1;     // Position in der Datei, -1 wenn noch nicht geschrieben
+        qint64 diskSize = 0;    // Größe in der Datei
+        qint64 first = 0;       // Fortlaufende Position des ersten Eintrags
+        qint64 textBytes = 0;   // Ungefähre Textmenge zum Abschließen des Blocks
+        int count = 0;          // Anzahl Einträge, auch wenn nicht dekodiert
+        quint64 revision = 0;   // Stand der letzten Änderung, eindeutig im Store
+        bool decoded = true;
+        bool dirty = true;      // Muss neu geschrieben werden
+        bool damaged = false;   // Prüfsumme oder Inhalt ungültig
+    };
+
+    /**
+     * @brief Zwischen Store und Kopien geteilter Schreibzustand der Datei
+     *
+     * Für die letzten WRITE_HISTORY Schreibvorgänge wird vermerkt, ab welcher
+     * Position die Datei überschrieben wurde.
+     */
+    struct FileGuard {
+        static const int WRITE_HISTORY = 256;
+        QReadWriteLock lock;
+        quint64 writes = 0;
+        qint64 writeStart[WRITE_HISTORY] = {};
+    };
+
+    /**
+     * @brief Anzahl der Aufträge aus saveInBackground(), die noch im Thread-Pool laufen
+     */
+    struct Background {
+        QMutex mutex;
+        QWaitCondition idle;
+        int running = 0;
+    };
+
+    QString m_path;
+    mutable QVector<Block> m_blocks;
+    qint64 m_firstPosition;     // Fortlaufende Position von Index 0
+    int m_size;
+    int m_firstDirty;           // Erster Block, der neu geschrieben werden muss
+    bool m_fileValid;           // Datei hat bereits das Blockformat
+    qint64 m_deadBytes;         // Ungenutzte Bytes vor dem Index, die kein Block mehr belegt
+    qint64 m_fileSize;
+    qint64 m_spareStart;        // Beim letzten Speichern frei gewordener Bereich, sonst leer
+    qint64 m_spareEnd;
+    QJsonObject m_state;
+    mutable QString m_errorString;
+    int m_backgroundJobs;       // Laufende Komprimierungen aus saveInBackground()
+    bool m_saveRequested;       // save() wurde währenddessen aufgerufen
+    quint64 m_revision;         // Zähler für Block::revision
+    quint32 m_fileVersion;      // Formatversion der Datei auf der Festplatte
+    bool m_repaired;            // Beschädigte Teile wurden übergangen
+    QStringList m_deadShards;   // Nicht mehr benötigte Abschnittsdateien, nach dem Speichern gelöscht
+    mutable TimeIndex m_times;  // Zeitpunkte aller Versionen, nur gültig wenn m_timesValid
+    mutable bool m_timesValid;
+    std::shared_ptr<FileGuard> m_fileGuard;
+    std::shared_ptr<Background> m_background;
+    quint64 m_writes;           // Stand von m_fileGuard->writes, zu dem die Blockpositionen passen
+    bool m_snapshot;            // Nur lesbare Kopie aus snapshot()
+
+    int blockOf(int index) const;
+    int activeBegin() const;
+    QString shardPath(const QString& name) const;
+    QString newShardName(qint64 firstTime) const;
+    bool loadShard(Block& block) const;
+    int sealableEnd() const;
+    bool sealBlocks(int end);
+    bool writeDirtyShards();
+    void dropShard(const Block& block);
+    void removeDeadShards();
+    void markDirty(int block);
+    bool readEncoded(int from, int to) const;
+    bool decodeRange(int from, int to) const;
+    void encodeDirtyBlocks();
+    bool rewrite();
+    bool writeChanges();
+    bool recover(QFile& file);
+    bool dropDamagedBlocks();
+    void keepDamagedCopy();
+    bool blockUnchanged(const Block& block) const;
+    void recordWrite(qint64 position);
+    bool ensureTimes() const;
+    QJsonObject indexObject() const;
+
+    static QByteArray encodeBlock(const QJsonArray& entries, qint64* textBytes = nullptr);
+    static bool decodeBlock(const QByteArray& encoded, QJsonArray* entries, qint64* textBytes = nullptr);
+    static qint64 textBytesOf(const QJsonArray& entries);
+    static bool writeShard(const QString& path, const QJsonArray& entries);
+    bool loadLegacy(const QByteArray& compressedData);
+};
+
+#endif
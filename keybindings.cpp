@@ -0,0 +1,125 @@
+#include "keybindings.h"
+#include <QKeyEvent>
+#include <QWidget>
+#include <QDebug>
+
+KeyBindings::KeyBindings(QObject *parent)
+    : QObject(parent)
+{
+    for (int c = 0; c < CommandCount; ++c) {
+        m_bindings[c] = defaultBindings(Command(c));
+    }
+    compile();
+}
+
+const char* KeyBindings::commandName(Command command)
+{
+    switch (command) {
+    case Undo: return "undo";
+    case Redo: return "redo";
+    case Copy: return "copy";
+    case Cut: return "cut";
+    case InsertLine: return "insert_line";
+    case ToggleTimeline: return "timeline";
+    case SortLines: return "sort_lines";
+    case UniqueLines: return "unique_lines";
+    case FilterLines: return "filter_lines";
+    case ReverseLines: return "reverse_lines";
+    case Find: return "find";
+    case GoToLine: return "go_to_line";
+    case CommandCount: break;
+    }
+    return "";
+}
+
+QList<QKeySequence> KeyBindings::defaultBindings(Command command)
+{
+    switch (command) {
+    case Undo: return {QKeySequence(Qt::CTRL | Qt::Key_Z)};
+    case Redo: return {QKeySequence(Qt::CTRL | Qt::Key_Y), QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Z)};
+    case Copy: return {QKeySequence(Qt::CTRL | Qt::Key_C)};
+    case Cut: return {QKeySequence(Qt::CTRL | Qt::Key_X)};
+    case InsertLine: return {QKeySequence(Qt::CTRL | Qt::Key_L)};
+    case ToggleTimeline: return {QKeySequence(Qt::CTRL | Qt::Key_T)};
+    case SortLines: return {QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_S)};
+    case UniqueLines: return {QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_U)};
+    case FilterLines: return {QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_F)};
+    case ReverseLines: return {QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_R)};
+    case Find: return {QKeySequence(Qt::CTRL | Qt::Key_F)};
+    case GoToLine: return {QKeySequence(Qt::CTRL | Qt::Key_G)};
+    case CommandCount: break;
+    }
+    return {};
+}
+
+void KeyBindings::load(QSettings& settings)
+{
+    settings.beginGroup("keybindings");
+    for (int c = 0; c < CommandCount; ++c) {
+        const QString name = commandName(Command(c));
+        m_bindings[c] = settings.contains(name)
+            ? QKeySequence::listFromString(settings.value(name).toString(), QKeySequence::PortableText)
+            : defaultBindings(Command(c));
+    }
+    settings.endGroup();
+    compile();
+}
+
+void KeyBindings::save(QSettings& settings) const
+{
+    settings.beginGroup("keybindings");
+    for (int c = 0; c < CommandCount; ++c) {
+        settings.setValue(commandName(Command(c)),
+                          QKeySequence::listToString(m_bindings[c], QKeySequence::PortableText));
+    }
+    settings.endGroup();
+}
+
+/**
+ * @brief Übersetzt die Belegungen in die Dispatch-Tabelle
+ *
+ * Nur einstufige Kombinationen werden unterstützt, spätere Einträge
+ * überschreiben frühere nicht.
+ */
+void KeyBindings::compile()
+{
+    m_dispatch.clear();
+    for (int c = 0; c < CommandCount; ++c) {
+        for (const QKeySequence& sequence : m_bindings[c]) {
+            if (sequence.count() != 1) {
+                qDebug() << "Mehrstufige Tastenkombination wird ignoriert:" << sequence.toString();
+                continue;
+            }
+            const int combined = sequence[0].toCombined();
+            if (m_dispatch.contains(combined)) {
+                qDebug() << "Tastenkombination doppelt belegt:" << sequence.toString();
+                continue;
+            }
+            m_dispatch.insert(combined, Command(c));
+        }
+    }
+}
+
+void KeyBindings::setHandler(Command command, std::function<void()> handler)
+{
+    m_handlers[command] = std::move(handler);
+}
+
+void KeyBindings::installOn(QWidget* widget)
+{
+    widget->installEventFilter(this);
+}
+
+bool KeyBindings::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::KeyPress) {
+        const QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        const Qt::KeyboardModifiers modifiers = keyEvent->modifiers() & ~Qt::KeypadModifier;
+        const auto it = m_dispatch.constFind(QKeyCombination(modifiers, Qt::Key(keyEvent->key())).toCombined());
+        if (it != m_dispatch.constEnd() && m_handlers[it.value()]) {
+            m_handlers[it.value()]();
+            return true;
+        }
+    }
+    return QObject::eventFilter(obj, event);
+}
@@ -0,0 +1,76 @@
+#ifndef KEYBINDINGS_H
+#define KEYBINDINGS_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QKeySequence>
+#include <QSettings>
+#include <functional>
+
+class QWidget;
+
+/**
+ * @brief Konfigurierbare Tastenbelegung für den Editor
+ *
+ * Die Belegungen stehen in settings.conf in der Gruppe [keybindings], z.B.
+ * "redo=Ctrl+Y; Ctrl+Shift+Z". Beim Laden werden sie in eine Hash-Tabelle
+ * von Tastenkombination auf Befehl übersetzt. Der Filter wird nur auf den
+ * Widgets installiert, für die die Belegung gelten soll, und erledigt pro
+ * Tastendruck einen einzigen Hash-Zugriff.
+ */
+class KeyBindings : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Command {
+        Undo,
+        Redo,
+        Copy,
+        Cut,
+        InsertLine,
+        ToggleTimeline,
+        SortLines,
+        UniqueLines,
+        FilterLines,
+        ReverseLines,
+        Find,
+        GoToLine,
+        CommandCount
+    };
+
+    explicit KeyBindings(QObject *parent = nullptr);
+
+    /**
+     * @brief Lädt die Belegungen, fehlende Befehle erhalten die Standardbelegung
+     */
+    void load(QSettings& settings);
+    void save(QSettings& settings) const;
+
+    /**
+     * @brief Legt fest, was ein Befehl auslöst
+     */
+    void setHandler(Command command, std::function<void()> handler);
+
+    /**
+     * @brief Aktiviert die Belegung für ein Widget und seine Kinder
+     */
+    void installOn(QWidget* widget);
+
+    QList<QKeySequence> bindings(Command command) const { return m_bindings[command]; }
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    QList<QKeySequence> m_bindings[CommandCount];
+    std::function<void()> m_handlers[CommandCount];
+    QHash<int, Command> m_dispatch;     // Kombination aus Taste und Modifikatoren -> Befehl
+
+    static const char* commandName(Command command);
+    static QList<QKeySequence> defaultBindings(Command command);
+    void compile();
+};
+
+#endif
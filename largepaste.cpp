@@ -0,0 +1,68 @@
+#include "largepaste.h"
+#include <QTimer>
+#include <QElapsedTimer>
+
+LargePaste::LargePaste(QTextEdit* target, const QString& text, const QTextCharFormat& format, QObject* parent)
+    : QObject(parent), m_target(target), m_text(text), m_format(format),
+      m_start(0), m_offset(0), m_canceled(false), m_signalsWereBlocked(false)
+{
+}
+
+void LargePaste::start()
+{
+    m_cursor = m_target->textCursor();
+    m_cursor.removeSelectedText();
+    m_start = m_cursor.position();
+
+    m_target->setReadOnly(true);
+    m_signalsWereBlocked = m_target->blockSignals(true);
+    QTimer::singleShot(0, this, &LargePaste::step);
+}
+
+void LargePaste::cancel()
+{
+    m_canceled = true;
+}
+
+void LargePaste::step()
+{
+    if (m_canceled) {
+        // Bereits eingefügten Teil wieder entfernen
+        m_cursor.setPosition(m_start);
+        m_cursor.setPosition(m_start + m_offset, QTextCursor::KeepAnchor);
+        m_cursor.removeSelectedText();
+        finish(false);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while (m_offset < m_text.size() && timer.elapsed() < TIME_SLICE_MS) {
+        int length = qMin(int(CHUNK_CHARS), int(m_text.size()) - m_offset);
+        // Surrogatpaare nicht trennen
+        if (m_offset + length < m_text.size() && m_text.at(m_offset + length - 1).isHighSurrogate()) {
+            ++length;
+        }
+        m_cursor.insertText(m_text.mid(m_offset, length), m_format);
+        m_offset += length;
+    }
+    emit progress(m_offset);
+
+    if (m_offset >= m_text.size()) {
+        finish(true);
+    } else {
+        QTimer::singleShot(0, this, &LargePaste::step);
+    }
+}
+
+void LargePaste::finish(bool completed)
+{
+    m_target->blockSignals(m_signalsWereBlocked);
+    m_target->setReadOnly(false);
+    if (completed) {
+        m_target->setTextCursor(m_cursor);
+        m_target->ensureCursorVisible();
+    }
+    m_text.clear();
+    emit finished(completed);
+}
@@ -0,0 +1,52 @@
+#ifndef LARGEPASTE_H
+#define LARGEPASTE_H
+
+#include <QObject>
+#include <QTextEdit>
+#include <QTextCursor>
+#include <QTextCharFormat>
+
+/**
+ * @brief Fügt großen Text stückweise ein, ohne die Oberfläche zu blockieren
+ *
+ * Pro Durchlauf der Ereignisschleife wird nur so viel eingefügt, wie in
+ * TIME_SLICE_MS passt. Währenddessen ist das Textfeld schreibgeschützt und
+ * sendet kein textChanged, der Text erhält direkt das Standardformat. Bei
+ * Abbruch wird der bereits eingefügte Teil wieder entfernt.
+ */
+class LargePaste : public QObject
+{
+    Q_OBJECT
+
+public:
+    LargePaste(QTextEdit* target, const QString& text, const QTextCharFormat& format, QObject* parent = nullptr);
+
+    void start();
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(int inserted);
+    void finished(bool completed);
+
+private slots:
+    void step();
+
+private:
+    static const int CHUNK_CHARS = 16 * 1024;
+    static const int TIME_SLICE_MS = 12;
+
+    QTextEdit* m_target;
+    QString m_text;
+    QTextCharFormat m_format;
+    QTextCursor m_cursor;
+    int m_start;
+    int m_offset;
+    bool m_canceled;
+    bool m_signalsWereBlocked;
+
+    void finish(bool completed);
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include "lineindex.h"
+#include "fingerprint.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <algorithm>
+
+LineIndex::LineIndex()
+    : m_lines(0), m_length(0), m_startsValid(false), m_fingerprint(0), m_fingerprintValid(false)
+{
+}
+
+void LineIndex::reset(const QTextDocument* document)
+{
+    QVector<int> lengths;
+    QVector<quint64> hashes;
+    lengths.reserve(document->blockCount());
+    hashes.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        lengths.append(block.length());
+        hashes.append(Fingerprint::ofNote(block.text()));
+    }
+    m_chunks.clear();
+    m_lines = 0;
+    m_length = 0;
+    replaceLines(0, 0, lengths, hashes);
+}
+
+void LineIndex::update(const QTextDocument* document, int position, int charsRemoved, int charsAdded)
+{
+    // Änderungen am Dokumentende enthalten das abschließende Trennzeichen
+    const qint64 oldLast = m_length - 1;
+    const int newLast = document->characterCount() - 1;
+    if (m_lines == 0 || position < 0 || position > oldLast) {
+        reset(document);
+        return;
+    }
+
+    // Alte Zeilen von der ersten bis zur letzten berührten durch die neuen Absätze ersetzen
+    const int first = lineAt(position);
+    const int last = lineAt(qMin(qint64(position) + charsRemoved, oldLast));
+    QVector<int> lengths;
+    QVector<quint64> hashes;
+    QTextBlock block = document->findBlock(position);
+    const QTextBlock end = document->findBlock(qMin(position + charsAdded, newLast));
+    while (block.isValid()) {
+        lengths.append(block.length());
+        hashes.append(Fingerprint::ofNote(block.text()));   // Absatztext samt Trennzeichen
+        if (block == end) break;
+        block = block.next();
+    }
+    replaceLines(first, last - first + 1, lengths, hashes);
+
+    if (m_length != document->characterCount() || m_lines != document->blockCount()) {
+        reset(document);
+    }
+}
+
+void LineIndex::ensureStarts() const
+{
+    if (m_startsValid) return;
+    m_chunkStarts.resize(m_chunks.size());
+    m_chunkLines.resize(m_chunks.size());
+    qint64 position = 0;
+    int line = 0;
+    for (int c = 0; c < m_chunks.size(); ++c) {
+        m_chunkStarts[c] = position;
+        m_chunkLines[c] = line;
+        position += m_chunks[c].length;
+        line += m_chunks[c].lengths.size();
+    }
+    m_startsValid = true;
+}
+
+int LineIndex::chunkOfLine(int line) const
+{
+    ensureStarts();
+    const auto it = std::upper_bound(m_chunkLines.cbegin(), m_chunkLines.cend(), line);
+    return qMax(0, int(it - m_chunkLines.cbegin()) - 1);
+}
+
+/**
+ * @brief Ersetzt count Zeilen ab first durch Zeilen der angegebenen Längen und Fingerprints
+ *
+ * Die betroffenen Abschnitte werden zusammengefasst und neu aufgeteilt,
+ * der Aufwand hängt nur von der Änderung und der Abschnittsgröße ab.
+ */
+void LineIndex::replaceLines(int first, int count, const QVector<int>& lengths, const QVector<quint64>& hashes)
+{
+    int firstChunk = 0;
+    int lastChunk = -1;
+    int firstLine = 0;
+    if (!m_chunks.isEmpty()) {
+        firstChunk = first < m_lines ? chunkOfLine(first) : m_chunks.size() - 1;
+        lastChunk = count > 0 ? chunkOfLine(first + count - 1) : firstChunk;
+        firstLine = m_chunkLines[firstChunk];
+    }
+
+    QVector<int> merged;
+    QVector<quint64> mergedHashes;
+    for (int c = firstChunk; c <= lastChunk; ++c) {
+        merged.append(m_chunks[c].lengths);
+        mergedHashes.append(m_chunks[c].hashes);
+    }
+    const int offset = first - firstLine;
+    qint64 removedLength = 0;
+    for (int i = offset; i < offset + count; ++i) removedLength += merged[i];
+    qint64 addedLength = 0;
+    for (int length : lengths) addedLength += length;
+
+    QVector<int> lines = merged.mid(0, offset);
+    lines.append(lengths);
+    lines.append(merged.mid(offset + count));
+    QVector<quint64> lineHashes = mergedHashes.mid(0, offset);
+    lineHashes.append(hashes);
+    lineHashes.append(mergedHashes.mid(offset + count));
+
+    // Kleine Ergebnisse bleiben ein Abschnitt, größere werden gleichmäßig geteilt
+    QVector<Chunk> chunks;
+    const int pieces = lines.size() <= 2 * CHUNK_LINES ? (lines.isEmpty() ? 0 : 1) : (lines.size() + CHUNK_LINES - 1) / CHUNK_LINES;
+    for (int p = 0; p < pieces; ++p) {
+        Chunk chunk;
+        const int from = int(qint64(lines.size()) * p / pieces);
+        const int to = int(qint64(lines.size()) * (p + 1) / pieces);
+        chunk.lengths = lines.mid(from, to - from);
+        chunk.hashes = lineHashes.mid(from, to - from);
+        for (int i = 0; i < chunk.lengths.size(); ++i) {
+            chunk.length += chunk.lengths[i];
+            chunk.hash = Fingerprint::concat(chunk.hash, chunk.hashes[i], Fingerprint::power(chunk.lengths[i]));
+        }
+        chunk.shift = Fingerprint::power(chunk.length);
+        chunks.append(chunk);
+    }
+    m_chunks.remove(firstChunk, lastChunk - firstChunk + 1);
+    for (int p = 0; p < chunks.size(); ++p) m_chunks.insert(firstChunk + p, chunks[p]);
+
+    m_lines += lengths.size() - count;
+    m_length += addedLength - removedLength;
+    m_startsValid = false;
+    m_fingerprintValid = false;
+}
+
+int LineIndex::lineAt(qint64 position) const
+{
+    if (m_chunks.isEmpty()) return 0;
+    ensureStarts();
+    const auto it = std::upper_bound(m_chunkStarts.cbegin(), m_chunkStarts.cend(), position);
+    const int c = qMax(0, int(it - m_chunkStarts.cbegin()) - 1);
+
+    qint64 start = m_chunkStarts[c];
+    const QVector<int>& lengths = m_chunks[c].lengths;
+    for (int i = 0; i < lengths.size(); ++i) {
+        start += lengths[i];
+        if (position < start) return m_chunkLines[c] + i;
+    }
+    return m_lines - 1;
+}
+
+qint64 LineIndex::lineStart(int line) const
+{
+    if (m_chunks.isEmpty() || line <= 0) return 0;
+    line = qMin(line, m_lines - 1);
+    const int c = chunkOfLine(line);
+    qint64 start = m_chunkStarts[c];
+    const QVector<int>& lengths = m_chunks[c].lengths;
+    for (int i = 0; i < line - m_chunkLines[c]; ++i) start += lengths[i];
+    return start;
+}
+
+quint64 LineIndex::fingerprint() const
+{
+    if (!m_fingerprintValid) {
+        m_fingerprint = 0;
+        for (const Chunk& chunk : m_chunks) m_fingerprint = Fingerprint::concat(m_fingerprint, chunk.hash, chunk.shift);
+        m_fingerprintValid = true;
+    }
+    return m_fingerprint;
+}
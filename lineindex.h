@@ -0,0 +1,84 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief Zeilenanfänge des Dokuments für Zeilennummer und Sprung zu einer Zeile
+ *
+ * Gespeichert werden die Längen aller Absätze (einschließlich Trennzeichen)
+ * in Abschnitten zu etwa CHUNK_LINES Zeilen. Eine Änderung ersetzt nur die
+ * Zeilen, die sie berührt; die Längen der neuen Zeilen liefern die Absätze
+ * des Dokuments, der Text selbst wird nicht gelesen. Für Abfragen werden
+ * die Anfänge der Abschnitte bei Bedarf aufsummiert und binär durchsucht,
+ * danach wird höchstens ein Abschnitt durchlaufen.
+ *
+ * Zu jeder Zeile gehört außerdem ihr Fingerprint, je Abschnitt wird daraus
+ * der Hash des Abschnitts gebildet. Der Fingerprint des Dokuments setzt
+ * nur die Hashes der Abschnitte zusammen, ohne den Text zu lesen.
+ */
+class LineIndex
+{
+public:
+    static const int CHUNK_LINES = 512;
+
+    LineIndex();
+
+    /**
+     * @brief Baut den Index aus allen Absätzen neu auf
+     */
+    void reset(const QTextDocument* document);
+
+    /**
+     * @brief Übernimmt eine Änderung aus QTextDocument::contentsChange
+     */
+    void update(const QTextDocument* document, int position, int charsRemoved, int charsAdded);
+
+    int lineCount() const { return m_lines; }
+
+    /**
+     * @brief Zeichen im Dokument, wie QTextDocument::characterCount()
+     */
+    qint64 length() const { return m_length; }
+
+    /**
+     * @brief Zeile (ab 0), in der position liegt
+     */
+    int lineAt(qint64 position) const;
+
+    /**
+     * @brief Position des ersten Zeichens einer Zeile (ab 0)
+     */
+    qint64 lineStart(int line) const;
+
+    /**
+     * @brief Fingerprint::ofNote() des Dokumenttexts
+     */
+    quint64 fingerprint() const;
+
+private:
+    struct Chunk {
+        QVector<int> lengths;
+        QVector<quint64> hashes;    // Fingerprint je Zeile samt Trennzeichen
+        qint64 length = 0;
+        quint64 hash = 0;
+        quint64 shift = 1;          // Fingerprint::power(length)
+    };
+
+    QVector<Chunk> m_chunks;
+    int m_lines;
+    qint64 m_length;
+    mutable QVector<qint64> m_chunkStarts;   // Position des ersten Zeichens je Abschnitt
+    mutable QVector<int> m_chunkLines;       // Nummer der ersten Zeile je Abschnitt
+    mutable bool m_startsValid;
+    mutable quint64 m_fingerprint;
+    mutable bool m_fingerprintValid;
+
+    void ensureStarts() const;
+    int chunkOfLine(int line) const;
+    void replaceLines(int first, int count, const QVector<int>& lengths, const QVector<quint64>& hashes);
+};
+
+#endif
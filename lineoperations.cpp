@@ -0,0 +1,209 @@
+#include "lineoperations.h"
+#include "parallel.h"
+#include <QVector>
+#include <QHash>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const qsizetype PARALLEL_CHARS = 256 * 1024;   // Darunter lohnt sich kein Thread
+const int PARALLEL_LINES = 16 * 1024;
+
+int chunkCount(qsizetype work, qsizetype threshold)
+{
+    if (work < threshold) return 1;
+    return qMax(1, QThread::idealThreadCount()) * 4;
+}
+
+qsizetype chunkBound(qsizetype size, int chunks, int chunk)
+{
+    return size * chunk / chunks;
+}
+
+/**
+ * @brief Zerlegt den Text in Zeilen, die Umbrüche werden je Teilstück parallel gesucht
+ */
+QVector<QStringView> splitLines(QStringView text)
+{
+    const int chunks = chunkCount(text.size(), PARALLEL_CHARS);
+    QVector<QVector<qsizetype>> breaks(chunks);
+    parallelFor(chunks, [&](int c) {
+        const qsizetype end = chunkBound(text.size(), chunks, c + 1);
+        for (qsizetype i = chunkBound(text.size(), chunks, c); i < end; ++i) {
+            if (text[i] == u'\n') breaks[c].append(i);
+        }
+    });
+
+    QVector<QStringView> lines;
+    qsizetype total = 1;
+    for (const QVector<qsizetype>& found : breaks) total += found.size();
+    lines.reserve(total);
+    qsizetype start = 0;
+    for (const QVector<qsizetype>& found : breaks) {
+        for (qsizetype pos : found) {
+            lines.append(text.mid(start, pos - start));
+            start = pos + 1;
+        }
+    }
+    lines.append(text.mid(start));
+    return lines;
+}
+
+/**
+ * @brief Setzt die Zeilen wieder zusammen, jeder Thread kopiert einen Teil
+ */
+QString joinLines(const QVector<QStringView>& lines, bool trailingNewline)
+{
+    if (lines.isEmpty()) return QString();
+    QVector<qsizetype> offsets(lines.size() + 1);
+    offsets[0] = 0;
+    for (int i = 0; i < lines.size(); ++i) {
+        offsets[i + 1] = offsets[i] + lines[i].size() + (i + 1 < lines.size() ? 1 : 0);
+    }
+
+    QString result(offsets.last() + (trailingNewline ? 1 : 0), Qt::Uninitialized);
+    QChar* out = result.data();
+    const int chunks = chunkCount(lines.size(), PARALLEL_LINES);
+    parallelFor(chunks, [&](int c) {
+        const int end = int(chunkBound(lines.size(), chunks, c + 1));
+        for (int i = int(chunkBound(lines.size(), chunks, c)); i < end; ++i) {
+            QChar* dst = out + offsets[i];
+            std::memcpy(dst, lines[i].data(), lines[i].size() * sizeof(QChar));
+            if (i + 1 < lines.size()) dst[lines[i].size()] = u'\n';
+        }
+    });
+    if (trailingNewline) out[offsets.last()] = u'\n';
+    return result;
+}
+
+/**
+ * @brief Wendet fn auf die Zeilen ohne abschließenden Umbruch an und setzt das Ergebnis zusammen
+ */
+template <typename Fn>
+QString transformLines(const QString& text, Fn fn)
+{
+    const bool trailingNewline = text.endsWith(u'\n');
+    QStringView body(text);
+    if (trailingNewline) body.chop(1);
+    QVector<QStringView> lines = splitLines(body);
+    fn(lines);
+    return joinLines(lines, trailingNewline);
+}
+
+template <typename Less>
+void parallelSort(QVector<QStringView>& lines, Less less)
+{
+    const int chunks = chunkCount(lines.size(), PARALLEL_LINES);
+    const qsizetype size = lines.size();
+    QStringView* data = lines.data();
+    parallelFor(chunks, [&](int c) {
+        std::stable_sort(data + chunkBound(size, chunks, c), data + chunkBound(size, chunks, c + 1), less);
+    });
+    if (chunks == 1) return;
+
+    // Sortierte Teilstücke paarweise zusammenführen, jede Runde parallel
+    QVector<QStringView> buffer(size);
+    QStringView* source = data;
+    QStringView* target = buffer.data();
+    for (int width = 1; width < chunks; width *= 2) {
+        const int merges = (chunks + 2 * width - 1) / (2 * width);
+        parallelFor(merges, [&](int m) {
+            const int first = m * 2 * width;
+            const qsizetype lo = chunkBound(size, chunks, first);
+            const qsizetype mid = chunkBound(size, chunks, qMin(first + width, chunks));
+            const qsizetype hi = chunkBound(size, chunks, qMin(first + 2 * width, chunks));
+            std::merge(source + lo, source + mid, source + mid, source + hi, target + lo, less);
+        });
+        std::swap(source, target);
+    }
+    if (source != data) {
+        std::copy(source, source + size, data);
+    }
+}
+
+} // namespace
+
+namespace LineOperations {
+
+QString sortLines(const QString& text, Qt::CaseSensitivity cs)
+{
+    return transformLines(text, [cs](QVector<QStringView>& lines) {
+        parallelSort(lines, [cs](QStringView a, QStringView b) { return a.compare(b, cs) < 0; });
+    });
+}
+
+QString uniqueLines(const QString& text)
+{
+    return transformLines(text, [](QVector<QStringView>& lines) {
+        const int count = int(lines.size());
+        QVector<size_t> hashes(count);
+        const int chunks = chunkCount(count, PARALLEL_LINES);
+        parallelFor(chunks, [&](int c) {
+            const int end = int(chunkBound(count, chunks, c + 1));
+            for (int i = int(chunkBound(count, chunks, c)); i < end; ++i) {
+                hashes[i] = qHash(lines[i]);
+            }
+        });
+
+        // Offene Adressierung mit linearer Sondierung, speichert Zeilennummern
+        qsizetype capacity = 16;
+        while (capacity < qsizetype(count) * 2) capacity *= 2;
+        const size_t mask = size_t(capacity - 1);
+        QVector<int> table(capacity, -1);
+        QVector<QStringView> unique;
+        unique.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            size_t slot = hashes[i] & mask;
+            bool duplicate = false;
+            while (table[slot] >= 0) {
+                const int other = table[slot];
+                if (hashes[other] == hashes[i] && lines[other] == lines[i]) {
+                    duplicate = true;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (duplicate) continue;
+            table[slot] = i;
+            unique.append(lines[i]);
+        }
+        lines = unique;
+    });
+}
+
+QString filterLines(const QString& text, const QRegularExpression& pattern, bool keepMatching)
+{
+    pattern.optimize();  // Einmal übersetzen, bevor die Threads zugreifen
+    return transformLines(text, [&pattern, keepMatching](QVector<QStringView>& lines) {
+        const int count = int(lines.size());
+        QVector<char> keep(count);
+        const int chunks = chunkCount(count, PARALLEL_LINES / 4);
+        parallelFor(chunks, [&](int c) {
+            const int end = int(chunkBound(count, chunks, c + 1));
+            for (int i = int(chunkBound(count, chunks, c)); i < end; ++i) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+                const bool matches = pattern.matchView(lines[i]).hasMatch();
+#else
+                const bool matches = pattern.match(lines[i]).hasMatch();
+#endif
+                keep[i] = matches == keepMatching;
+            }
+        });
+
+        int kept = 0;
+        for (int i = 0; i < count; ++i) {
+            if (keep[i]) lines[kept++] = lines[i];
+        }
+        lines.resize(kept);
+    });
+}
+
+QString reverseLines(const QString& text)
+{
+    return transformLines(text, [](QVector<QStringView>& lines) {
+        std::reverse(lines.begin(), lines.end());
+    });
+}
+
+} // namespace LineOperations
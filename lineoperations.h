@@ -0,0 +1,45 @@
+#ifndef LINEOPERATIONS_H
+#define LINEOPERATIONS_H
+
+#include <QString>
+#include <QRegularExpression>
+
+/**
+ * @brief Zeilenweise Massenoperationen für große Notizen
+ *
+ * Alle Funktionen arbeiten auf einem Zeilenindex aus QStringView, der
+ * parallel aufgebaut wird; kopiert wird erst beim Zusammensetzen des
+ * Ergebnisses, ebenfalls parallel. Ein abschließender Zeilenumbruch bleibt
+ * am Ende erhalten.
+ */
+namespace LineOperations {
+
+/**
+ * @brief Sortiert die Zeilen stabil nach UTF-16-Codeeinheiten
+ *
+ * Teilstücke werden parallel sortiert und danach paarweise parallel
+ * zusammengeführt.
+ */
+QString sortLines(const QString& text, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+
+/**
+ * @brief Entfernt doppelte Zeilen, das erste Vorkommen bleibt an seiner Stelle
+ *
+ * Die Hashwerte werden parallel berechnet, der Abgleich läuft über eine
+ * offene Hashtabelle.
+ */
+QString uniqueLines(const QString& text);
+
+/**
+ * @brief Behält nur die Zeilen, auf die pattern passt, oder entfernt genau diese
+ */
+QString filterLines(const QString& text, const QRegularExpression& pattern, bool keepMatching);
+
+/**
+ * @brief Kehrt die Reihenfolge der Zeilen um
+ */
+QString reverseLines(const QString& text);
+
+} // namespace LineOperations
+
+#endif
@@ -1,12 +1,146 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QTextEdit>
+#include <QJsonObject>
+#include <QDebug>
+#include <QLocalSocket>
+#include <QFile>
+#include <cstdio>
+#include <cstring>
 #include "editor.h"
+#include "historystore.h"
+#include "typingreplay.h"
+
+namespace {
+
+/**
+ * @brief Legt eine History mit der gewünschten Tiefe und Notizgröße an
+ */
+bool prepareReplayHistory(const QString& historyFile, int noteSize, int depth)
+{
+    HistoryStore store;
+    store.open(historyFile);  // Setzt den Pfad, die Datei existiert noch nicht
+    store.clear();
+
+    const QString text = TypingReplay::syntheticText(noteSize, 1);
+    const int steps = qMax(1, depth);
+    for (int i = 0; i < steps; ++i) {
+        // Jede Version ist etwas länger als die vorherige, wie beim Tippen
+        const int length = qMax(0, int(text.size()) - (steps - 1 - i));
+        QJsonObject entry;
+        entry["text"] = text.left(length);
+        entry["cursor"] = length;
+        store.append(entry);
+    }
+    store.setCurrentIndex(store.size() - 1);
+    return store.save();
+}
+
+/**
+ * @brief Schickt eine Abfrage an die laufende Instanz und gibt die Antwort aus
+ */
+int runQuery(const QString& request)
+{
+    QLocalSocket socket;
+    socket.connectToServer(Editor::getServerName());
+    if (!socket.waitForConnected(1000)) {
+        fprintf(stderr, "quicknote: no running instance\n");
+        return 1;
+    }
+    socket.write(request.toUtf8() + "\n");
+
+    // Antwort stückweise weiterreichen, bis die Instanz die Verbindung schließt
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    while (socket.state() == QLocalSocket::ConnectedState || socket.bytesAvailable() > 0) {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(-1)) break;
+        out.write(socket.readAll());
+    }
+    out.flush();
+    return 0;
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
+    // Messläufe und Abfragen brauchen kein sichtbares Fenster
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--replay-typing") == 0 || std::strcmp(argv[i], "--query") == 0)
+            && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
+
     QApplication app(argc, argv);
-    
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption replayOption("replay-typing", "Replay keystrokes in a temporary data directory and report latency percentiles.");
+    const QCommandLineOption scriptOption("replay-script", "Recorded input to replay (UTF-8 text, \\b for backspace).", "file");
+    const QCommandLineOption keysOption("replay-keys", "Number of synthetic keystrokes.", "n", "2000");
+    const QCommandLineOption intervalOption("replay-interval", "Milliseconds between keystrokes, 0 for bursts.", "ms", "0");
+    const QCommandLineOption noteSizeOption("replay-note-size", "Characters in the note before typing starts.", "n", "20000");
+    const QCommandLineOption depthOption("replay-history", "Number of history versions before typing starts.", "n", "100");
+    const QCommandLineOption reportOption("replay-report", "Write the results as JSON to this file.", "file");
+    const QCommandLineOption allocBudgetOption("replay-alloc-budget", "Fail if p99 allocations per keystroke exceed n (needs QUICKNOTE_ALLOC_STATS).", "n");
+    const QCommandLineOption byteBudgetOption("replay-bytes-budget", "Fail if p99 bytes allocated per keystroke exceed n (needs QUICKNOTE_ALLOC_STATS).", "n");
+    const QCommandLineOption profileOption("profile-startup", "Print how long each startup step takes.");
+    const QCommandLineOption queryOption("query", "Send a read-only query to the running instance and print the answer: "
+                                         "get-current, get-version N, list-versions, diff N M or search TEXT.", "request");
+    parser.addOptions({replayOption, scriptOption, keysOption, intervalOption, noteSizeOption, depthOption, reportOption,
+                       allocBudgetOption, byteBudgetOption, profileOption, queryOption});
+    parser.process(app);
+    Editor::setStartupProfiling(parser.isSet(profileOption));
+
+    if (parser.isSet(queryOption)) {
+        return runQuery(parser.value(queryOption));
+    }
+
+    if (parser.isSet(replayOption)) {
+        // Eigenes Datenverzeichnis, damit die echte History unberührt bleibt
+        QTemporaryDir dataDir;
+        if (!dataDir.isValid()) {
+            qDebug() << "Temporäres Verzeichnis konnte nicht angelegt werden";
+            return 1;
+        }
+        qputenv("QUICKNOTE_DATA_DIR", dataDir.path().toLocal8Bit());
+        if (!prepareReplayHistory(dataDir.filePath("history.gz"),
+                                  parser.value(noteSizeOption).toInt(),
+                                  parser.value(depthOption).toInt())) {
+            qDebug() << "History für die Messung konnte nicht angelegt werden";
+            return 1;
+        }
+
+        Editor editor;
+        QTextEdit* textEdit = editor.findChild<QTextEdit*>();
+        if (!textEdit) return 1;
+        editor.show();
+
+        TypingReplay::Options options;
+        options.scriptFile = parser.value(scriptOption);
+        options.keystrokes = parser.value(keysOption).toInt();
+        options.intervalMs = parser.value(intervalOption).toInt();
+        options.reportFile = parser.value(reportOption);
+        if (parser.isSet(allocBudgetOption)) options.allocationBudget = parser.value(allocBudgetOption).toLongLong();
+        if (parser.isSet(byteBudgetOption)) options.byteBudget = parser.value(byteBudgetOption).toLongLong();
+        TypingReplay replay(textEdit, options);
+        QObject::connect(&replay, &TypingReplay::finished, &app, &QCoreApplication::exit);
+
+        // Erst tippen, wenn die History im Hintergrund geladen ist
+        if (editor.isHistoryReady()) {
+            if (!replay.start()) return 1;
+        } else {
+            QObject::connect(&editor, &Editor::historyReady, &replay, [&replay]() {
+                if (!replay.start()) QCoreApplication::exit(1);
+            });
+        }
+        return app.exec();
+    }
+
     Editor editor;
     editor.hide();  // Verstecke das Fenster direkt nach der Erstellung
     
    return app.exec();
-} 
\ No newline at end of file
+}
@@ -0,0 +1,81 @@
+#include "mirrorfile.h"
+#include "debouncedwriter.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+MirrorFile::MirrorFile(QObject *parent)
+    : QObject(parent), m_state(std::make_shared<State>()), m_writer(new DebouncedWriter(DELAY_MS, this))
+{
+}
+
+MirrorFile::~MirrorFile()
+{
+    flush();
+}
+
+void MirrorFile::setPath(const QString& path)
+{
+    if (path == m_path) return;
+    m_path = path;
+    if (m_path.isEmpty()) m_writer->cancel();
+}
+
+void MirrorFile::update(const QString& text)
+{
+    if (m_path.isEmpty()) return;
+    const std::shared_ptr<State> state = m_state;
+    const QString path = m_path;
+    m_writer->schedule([state, path, text]() {
+        write(*state, path, text);
+    });
+}
+
+void MirrorFile::flush()
+{
+    m_writer->flush();
+}
+
+/**
+ * @brief Schreibt den Text, bei geändertem Ende nur den abweichenden Teil
+ */
+void MirrorFile::write(State& state, const QString& path, const QString& text)
+{
+    if (path != state.path) {
+        state.path = path;
+        state.written = QByteArray();
+    }
+    const QByteArray data = text.toUtf8();
+
+    const QFileInfo info(path);
+    const bool unchanged = !state.written.isNull() && info.exists()
+        && info.size() == state.written.size() && info.lastModified() == state.modified;
+    if (unchanged && data == state.written) return;
+
+    bool done = false;
+    if (unchanged) {
+        const qsizetype common = qMin(data.size(), state.written.size());
+        const qsizetype prefix = std::mismatch(data.constBegin(), data.constBegin() + common,
+                                               state.written.constBegin()).first - data.constBegin();
+        const qsizetype tail = data.size() - prefix;
+        if (prefix > 0 && tail <= MAX_TAIL_BYTES) {
+            QFile file(path);
+            done = file.open(QIODevice::ReadWrite) && file.seek(prefix)
+                && file.write(data.constData() + prefix, tail) == tail
+                && file.resize(data.size());
+        }
+    }
+    if (!done) {
+        QSaveFile out(path);
+        if (!out.open(QIODevice::WriteOnly) || out.write(data) != data.size() || !out.commit()) {
+            qDebug() << "Textkopie kann nicht geschrieben werden:" << path << out.errorString();
+            state.written = QByteArray();
+            return;
+        }
+    }
+
+    state.written = data;
+    state.modified = QFileInfo(path).lastModified();
+}
@@ -0,0 +1,71 @@
+#ifndef MIRRORFILE_H
+#define MIRRORFILE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <memory>
+
+class DebouncedWriter;
+
+/**
+ * @brief Hält eine Kopie der Notiz als reinen Text, z.B. für grep oder Backups
+ *
+ * update() merkt sich nur den Text (implizit geteilt, ohne Kopie); geschrieben
+ * wird über DebouncedWriter höchstens alle DELAY_MS im Thread-Pool, dort
+ * wird auch erst nach UTF-8 gewandelt. Hat sich nur das Ende geändert und ist
+ * die Datei seit dem letzten Schreiben unverändert, wird nur ab dem ersten
+ * abweichenden Byte überschrieben und die Länge angepasst. Sonst wird die
+ * Datei über QSaveFile komplett und atomar ersetzt.
+ *
+ * Das Schreiben an Ort und Stelle ist nicht atomar: Wer die Datei genau
+ * währenddessen liest, kann ein halb geschriebenes Ende sehen, nach einem
+ * Absturz bleibt es so stehen, bis zum nächsten Schreiben. Dafür kostet
+ * Tippen am Ende einer großen Notiz nur die geänderten Bytes.
+ */
+class MirrorFile : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DELAY_MS = 1000;
+    static const int MAX_TAIL_BYTES = 256 * 1024;   // Größere Änderungen ersetzen die ganze Datei
+
+    explicit MirrorFile(QObject *parent = nullptr);
+    ~MirrorFile();
+
+    /**
+     * @brief Zieldatei, leer schaltet die Kopie ab
+     */
+    void setPath(const QString& path);
+    QString path() const { return m_path; }
+
+    /**
+     * @brief Plant das Schreiben des Texts
+     */
+    void update(const QString& text);
+
+    /**
+     * @brief Schreibt einen ausstehenden Text sofort im aufrufenden Thread
+     */
+    void flush();
+
+private:
+    /**
+     * @brief Stand der Datei, nur von den nacheinander laufenden Schreibvorgängen benutzt
+     */
+    struct State {
+        QString path;
+        QByteArray written;         // Zuletzt geschriebener Inhalt
+        QDateTime modified;         // Änderungszeit danach, erkennt fremde Änderungen
+    };
+
+    std::shared_ptr<State> m_state;
+    DebouncedWriter* m_writer;
+    QString m_path;
+
+    static void write(State& state, const QString& path, const QString& text);
+};
+
+#endif
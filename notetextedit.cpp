@@ -0,0 +1,69 @@
+#include "notetextedit.h"
+#include <QKeyEvent>
+#include <QPainter>
+
+NoteTextEdit::NoteTextEdit(QWidget *parent)
+    : QTextEdit(parent), m_completionPosition(-1)
+{
+    setAcceptRichText(false);
+
+    // Cursor bewegt: Vorschlag gilt nicht mehr
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this]() {
+        if (!m_completion.isEmpty() && textCursor().position() != m_completionPosition) setCompletion(QString());
+    });
+}
+
+void NoteTextEdit::setCompletion(const QString& completion)
+{
+    if (completion.isEmpty() && m_completion.isEmpty()) return;
+    m_completion = completion;
+    m_completionPosition = textCursor().position();
+    viewport()->update();
+}
+
+bool NoteTextEdit::canInsertFromMimeData(const QMimeData *source) const
+{
+    return source->hasText();
+}
+
+void NoteTextEdit::insertFromMimeData(const QMimeData *source)
+{
+    const QString text = source->text();
+    if (text.isEmpty()) return;
+
+    if (text.size() >= LARGE_PASTE_CHARS) {
+        emit largePaste(text);
+        return;
+    }
+    textCursor().insertText(text);
+    ensureCursorVisible();
+}
+
+void NoteTextEdit::keyPressEvent(QKeyEvent *event)
+{
+    if (!m_completion.isEmpty()) {
+        const QString completion = m_completion;
+        setCompletion(QString());
+        if (event->key() == Qt::Key_Tab && event->modifiers() == Qt::NoModifier) {
+            textCursor().insertText(completion);
+            ensureCursorVisible();
+            return;
+        }
+    }
+    QTextEdit::keyPressEvent(event);
+}
+
+void NoteTextEdit::paintEvent(QPaintEvent *event)
+{
+    QTextEdit::paintEvent(event);
+    if (m_completion.isEmpty() || textCursor().hasSelection()) return;
+
+    // Wie der Text, nur halb durchsichtig
+    QPainter painter(viewport());
+    const QRect cursor = cursorRect();
+    QColor color = palette().color(QPalette::Text);
+    color.setAlpha(110);
+    painter.setPen(color);
+    painter.setFont(currentCharFormat().font());
+    painter.drawText(QPoint(cursor.right() + 1, cursor.top() + painter.fontMetrics().ascent()), m_completion);
+}
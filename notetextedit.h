@@ -0,0 +1,46 @@
+#ifndef NOTETEXTEDIT_H
+#define NOTETEXTEDIT_H
+
+#include <QTextEdit>
+#include <QMimeData>
+
+/**
+ * @brief Textfeld des Editors, das nur reinen Text übernimmt
+ *
+ * Einfügen und Drag&Drop lesen ausschließlich text/plain, die Verarbeitung
+ * von HTML und Rich Text in QTextEdit entfällt. Große Texte werden nicht
+ * direkt eingefügt, sondern über largePaste() an den Editor weitergegeben.
+ *
+ * Eine Wortvervollständigung wird hinter dem Cursor grau angezeigt, ohne
+ * das Dokument zu ändern; Tab übernimmt sie, jede andere Taste verwirft sie.
+ */
+class NoteTextEdit : public QTextEdit
+{
+    Q_OBJECT
+
+public:
+    static const int LARGE_PASTE_CHARS = 256 * 1024;  // Ab dieser Länge stückweise einfügen
+
+    explicit NoteTextEdit(QWidget *parent = nullptr);
+
+    /**
+     * @brief Zeigt den Rest eines Worts hinter dem Cursor an, leer blendet ihn aus
+     */
+    void setCompletion(const QString& completion);
+    QString completion() const { return m_completion; }
+
+signals:
+    void largePaste(const QString& text);
+
+protected:
+    bool canInsertFromMimeData(const QMimeData *source) const override;
+    void insertFromMimeData(const QMimeData *source) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QString m_completion;
+    int m_completionPosition;   // Cursorposition, für die m_completion gilt
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QThread>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <atomic>
+
+/**
+ * @brief Führt fn(i) für alle i in [0, count) verteilt auf den globalen Thread-Pool aus
+ *
+ * Der aufrufende Thread arbeitet selbst mit. Zusätzliche Worker werden nur
+ * gestartet, wenn im Pool sofort ein Thread frei ist, daher darf die Funktion
+ * auch aus einem Pool-Thread heraus aufgerufen werden. fn muss für
+ * verschiedene i gleichzeitig aufrufbar sein.
+ */
+template <typename Fn>
+void parallelFor(int count, Fn fn)
+{
+    if (count <= 0) return;
+
+    std::atomic<int> next(0);
+    const auto work = [&]() {
+        int i;
+        while ((i = next.fetch_add(1)) < count) {
+            fn(i);
+        }
+    };
+
+    if (count == 1) {
+        work();
+        return;
+    }
+
+    QSemaphore finished;
+    int started = 0;
+    const int helpers = qMin(count, QThread::idealThreadCount()) - 1;
+    for (int w = 0; w < helpers; ++w) {
+        if (!QThreadPool::globalInstance()->tryStart([&]() { work(); finished.release(); })) break;
+        ++started;
+    }
+    work();
+    finished.acquire(started);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#include "processmemory.h"
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <malloc.h>
+#endif
+
+namespace ProcessMemory {
+
+qint64 residentSetSize()
+{
+#ifdef Q_OS_LINUX
+    // Zweites Feld von /proc/self/statm: residente Seiten
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+void releaseFreeMemory()
+{
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+} // namespace ProcessMemory
@@ -0,0 +1,23 @@
+#ifndef PROCESSMEMORY_H
+#define PROCESSMEMORY_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Hilfsfunktionen zum Speicherverbrauch des eigenen Prozesses
+ */
+namespace ProcessMemory {
+
+/**
+ * @brief Aktuell belegter physischer Speicher (RSS) in Bytes, -1 wenn unbekannt
+ */
+qint64 residentSetSize();
+
+/**
+ * @brief Gibt freigegebenen Heap-Speicher soweit möglich an das System zurück
+ */
+void releaseFreeMemory();
+
+} // namespace ProcessMemory
+
+#endif
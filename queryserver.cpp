@@ -0,0 +1,363 @@
+#include "queryserver.h"
+#include "diffengine.h"
+#include <QLocalSocket>
+#include <QSemaphore>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonDocument>
+#include <QThread>
+#include <atomic>
+
+struct QueryServer::Stream {
+    QLocalSocket* socket = nullptr;     // Nur im Thread des Servers benutzen, nullptr nach dem Trennen
+    QSemaphore credits;                 // Freie Plätze für weitere Stücke
+    std::atomic<bool> cancelled{false};
+    QList<qint64> pending;              // Noch nicht gesendete Bytes je Stück, im Thread des Servers
+
+    Stream() : credits(MAX_PENDING_CHUNKS) {}
+};
+
+namespace {
+
+const int CONTEXT_LINES = 3;
+
+/**
+ * @brief Sammelt die Antwort und gibt sie in Stücken fester Größe weiter
+ */
+class ChunkWriter
+{
+public:
+    ChunkWriter(int chunkSize, std::function<bool(const QByteArray&)> send)
+        : m_chunkSize(chunkSize), m_send(std::move(send)), m_ok(true)
+    {
+        m_buffer.reserve(chunkSize);
+    }
+
+    /**
+     * @brief false sobald der Client nicht mehr liest
+     */
+    bool write(const QByteArray& data)
+    {
+        qsizetype pos = 0;
+        if (!m_buffer.isEmpty()) {
+            pos = qMin<qsizetype>(m_chunkSize - m_buffer.size(), data.size());
+            m_buffer.append(data.constData(), pos);
+            if (m_buffer.size() < m_chunkSize) return m_ok;
+            sendBuffer();
+        }
+        while (m_ok && data.size() - pos >= m_chunkSize) {
+            m_ok = m_send(data.mid(pos, m_chunkSize));
+            pos += m_chunkSize;
+        }
+        m_buffer.append(data.constData() + pos, data.size() - pos);
+        return m_ok;
+    }
+
+    bool write(const QString& text) { return write(text.toUtf8()); }
+
+    bool finish()
+    {
+        if (!m_buffer.isEmpty()) sendBuffer();
+        return m_ok;
+    }
+
+private:
+    int m_chunkSize;
+    std::function<bool(const QByteArray&)> m_send;
+    QByteArray m_buffer;
+    bool m_ok;
+
+    void sendBuffer()
+    {
+        if (m_ok) m_ok = m_send(m_buffer);
+        m_buffer.clear();
+    }
+};
+
+/**
+ * @brief Durchläuft alle Versionen, Blöcke werden stapelweise parallel dekodiert
+ *
+ * Nach jedem Stapel wird der Cache geleert, der Speicherbedarf bleibt begrenzt.
+ * @return false wenn eine Version nicht gelesen werden konnte
+ */
+bool forEachVersion(HistoryStore& store, const std::function<bool(int index, const QJsonObject& entry)>& fn)
+{
+    const int batch = HistoryStore::BLOCK_ENTRIES * qMax(1, QThread::idealThreadCount()) * 2;
+    for (int first = 0; first < store.size(); first += batch) {
+        const int last = qMin(store.size(), first + batch) - 1;
+        store.prefetch(first, last);
+        for (int index = first; index <= last; ++index) {
+            const QJsonObject entry = store.entry(index);
+            if (entry.isEmpty()) return false;
+            if (!fn(index, entry)) return true;
+        }
+        store.releaseCache();
+    }
+    return true;
+}
+
+QString formatTime(qint64 msecs)
+{
+    return msecs > 0 ? QDateTime::fromMSecsSinceEpoch(msecs).toString(Qt::ISODate) : QString("-");
+}
+
+QString firstLine(QStringView text, qsizetype from = 0)
+{
+    const qsizetype start = from > 0 ? text.lastIndexOf(u'\n', from - 1) + 1 : 0;
+    qsizetype end = text.indexOf(u'\n', start);
+    if (end < 0) end = text.size();
+    QString line = text.mid(start, qMin<qsizetype>(end - start, 200)).toString();
+    line.replace(u'\t', u' ');
+    return line;
+}
+
+/**
+ * @brief Schreibt die Unterschiede zweier Texte im Unified-Format
+ */
+bool writeUnifiedDiff(ChunkWriter& out, const QString& oldText, const QString& newText,
+                      const QString& oldName, const QString& newName)
+{
+    const QVector<DiffEngine::Hunk> hunks = DiffEngine::diffLines(oldText, newText);
+    const QVector<QStringView> oldLines = DiffEngine::splitLines(oldText);
+    const QVector<QStringView> newLines = DiffEngine::splitLines(newText);
+    const auto isEqual = [&hunks](int h) { return hunks[h].type == DiffEngine::OpType::Equal; };
+
+    if (!out.write(QString("--- %1\n+++ %2\n").arg(oldName, newName))) return false;
+
+    int h = 0;
+    while (h < hunks.size()) {
+        if (isEqual(h)) {
+            ++h;
+            continue;
+        }
+
+        // Änderungen zusammenfassen, solange der Abstand höchstens zweimal den Kontext beträgt
+        const int first = h;
+        int last = h;
+        for (int next = h + 1; next < hunks.size(); ++next) {
+            if (!isEqual(next)) {
+                last = next;
+            } else if (hunks[next].count > 2 * CONTEXT_LINES) {
+                break;
+            }
+        }
+
+        const int before = first > 0 ? qMin(CONTEXT_LINES, hunks[first - 1].count) : 0;
+        const int after = last + 1 < hunks.size() ? qMin(CONTEXT_LINES, hunks[last + 1].count) : 0;
+        const int oldStart = hunks[first].oldLine - before;
+        const int newStart = hunks[first].newLine - before;
+        const DiffEngine::Hunk& end = hunks[last];
+        const int oldEnd = end.oldLine + (end.type == DiffEngine::OpType::Delete ? end.count : 0) + after;
+        const int newEnd = end.newLine + (end.type == DiffEngine::OpType::Insert ? end.count : 0) + after;
+
+        QString text = QString("@@ -%1,%2 +%3,%4 @@\n").arg(oldStart + 1).arg(oldEnd - oldStart)
+                                                        .arg(newStart + 1).arg(newEnd - newStart);
+        const auto appendLines = [&text](QChar prefix, const QVector<QStringView>& lines, int from, int count) {
+            for (int i = from; i < from + count; ++i) {
+                text += prefix;
+                text += lines[i];
+                text += u'\n';
+            }
+        };
+        appendLines(u' ', oldLines, oldStart, before);
+        for (int k = first; k <= last; ++k) {
+            const DiffEngine::Hunk& hunk = hunks[k];
+            if (hunk.type == DiffEngine::OpType::Equal) {
+                appendLines(u' ', oldLines, hunk.oldLine, hunk.count);
+            } else if (hunk.type == DiffEngine::OpType::Delete) {
+                appendLines(u'-', oldLines, hunk.oldLine, hunk.count);
+            } else {
+                appendLines(u'+', newLines, hunk.newLine, hunk.count);
+            }
+        }
+        appendLines(u' ', oldLines, oldEnd - after, after);
+        if (!out.write(text)) return false;
+        h = last + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+QueryServer::QueryServer(std::function<Snapshot()> snapshotProvider, QObject *parent)
+    : QObject(parent), m_snapshotProvider(std::move(snapshotProvider))
+{
+    // Abfragen nacheinander in einem eigenen Thread, der globale Pool bleibt frei
+    m_pool.setMaxThreadCount(1);
+}
+
+QueryServer::~QueryServer()
+{
+    for (const std::shared_ptr<Stream>& stream : m_streams) {
+        stream->cancelled = true;
+        stream->credits.release(MAX_PENDING_CHUNKS);
+    }
+    m_pool.waitForDone();
+}
+
+void QueryServer::answer(QLocalSocket* client, const QByteArray& request)
+{
+    if (client->state() != QLocalSocket::ConnectedState) {
+        client->deleteLater();
+        return;
+    }
+
+    auto stream = std::make_shared<Stream>();
+    stream->socket = client;
+    m_streams.append(stream);
+
+    // Erst wenn ein Stück beim Client angekommen ist, darf das nächste folgen
+    connect(client, &QLocalSocket::bytesWritten, this, [stream](qint64 bytes) {
+        while (bytes > 0 && !stream->pending.isEmpty()) {
+            const qint64 sent = qMin(bytes, stream->pending.first());
+            stream->pending.first() -= sent;
+            bytes -= sent;
+            if (stream->pending.first() == 0) {
+                stream->pending.removeFirst();
+                stream->credits.release();
+            }
+        }
+    });
+    connect(client, &QLocalSocket::disconnected, this, [this, stream, client]() {
+        stream->cancelled = true;
+        stream->credits.release(MAX_PENDING_CHUNKS);  // Wartenden Thread wecken
+        stream->socket = nullptr;
+        m_streams.removeOne(stream);
+        client->deleteLater();
+    });
+
+    Snapshot snapshot = m_snapshotProvider();
+    m_pool.start([this, stream, request, snapshot = std::move(snapshot)]() mutable {
+        run(stream, request, snapshot);
+    });
+}
+
+/**
+ * @brief Bearbeitet eine Abfrage im Thread des Pools
+ */
+void QueryServer::run(const std::shared_ptr<Stream>& stream, const QByteArray& request, Snapshot& snapshot)
+{
+    ChunkWriter out(CHUNK_SIZE, [this, stream](const QByteArray& chunk) {
+        while (!stream->credits.tryAcquire(1, 100)) {
+            if (stream->cancelled) return false;
+        }
+        if (stream->cancelled) return false;
+        QMetaObject::invokeMethod(this, [this, stream, chunk]() { deliver(stream, chunk); }, Qt::QueuedConnection);
+        return true;
+    });
+
+    const QString line = QString::fromUtf8(request);
+    const QString command = line.section(u' ', 0, 0);
+    const QString argument = line.mid(command.size() + 1);
+    HistoryStore& store = snapshot.store;
+
+    const auto versionIndex = [&store](const QString& text, int* index) {
+        bool ok = false;
+        *index = text.toInt(&ok) - 1;
+        return ok && *index >= 0 && *index < store.size();
+    };
+    const auto versionText = [&store](int index, QString* text) {
+        const QJsonObject entry = store.entry(index);
+        if (entry.isEmpty()) return false;
+        *text = entry["text"].toString();
+        return true;
+    };
+
+    QString error;
+    if (command == "get-current") {
+        out.write(snapshot.currentText);
+    } else if (command == "stats") {
+        out.write(QJsonDocument(snapshot.stats).toJson());
+    } else if (command != "get-version" && command != "get-at" && command != "list-versions" && command != "diff"
+               && command != "search") {
+        error = "unknown command: " + command;
+    } else if (!snapshot.historyReady) {
+        error = "history is still loading";
+    } else if (command == "get-version") {
+        int index;
+        QString text;
+        if (!versionIndex(argument, &index)) {
+            error = QString("version %1 does not exist (1-%2)").arg(argument).arg(store.size());
+        } else if (!versionText(index, &text)) {
+            error = store.errorString();
+        } else {
+            out.write(text);
+        }
+    } else if (command == "get-at") {
+        const QDateTime time = QDateTime::fromString(argument, Qt::ISODate);
+        const int index = time.isValid() ? store.versionAt(time.toMSecsSinceEpoch()) : -1;
+        QString text;
+        if (!time.isValid()) {
+            error = "usage: get-at YYYY-MM-DDTHH:MM[:SS]";
+        } else if (index < 0) {
+            error = "no version existed at " + argument;
+        } else if (!versionText(index, &text)) {
+            error = store.errorString();
+        } else {
+            out.write(text);
+        }
+    } else if (command == "list-versions") {
+        QHash<qint64, int> versionOfId;
+        const bool ok = forEachVersion(store, [&](int index, const QJsonObject& entry) {
+            const qint64 id = entry["id"].toInteger(-1);
+            if (id >= 0) versionOfId.insert(id, index + 1);
+            const QString text = entry["text"].toString();
+            return out.write(QString("%1\t%2\t%3\t%4\t%5\n")
+                             .arg(index + 1)
+                             .arg(versionOfId.value(entry["parentId"].toInteger(-1), 0))
+                             .arg(formatTime(entry["time"].toInteger()))
+                             .arg(text.size())
+                             .arg(firstLine(text)));
+        });
+        if (!ok) error = store.errorString();
+    } else if (command == "diff") {
+        const QStringList versions = argument.split(u' ', Qt::SkipEmptyParts);
+        int oldIndex = -1;
+        int newIndex = -1;
+        QString oldText;
+        QString newText;
+        if (versions.size() != 2 || !versionIndex(versions[0], &oldIndex) || !versionIndex(versions[1], &newIndex)) {
+            error = QString("usage: diff N M with versions 1-%1").arg(store.size());
+        } else if (!versionText(oldIndex, &oldText) || !versionText(newIndex, &newText)) {
+            error = store.errorString();
+        } else {
+            writeUnifiedDiff(out, oldText, newText, "version " + versions[0], "version " + versions[1]);
+        }
+    } else if (command == "search") {
+        if (argument.isEmpty()) {
+            error = "usage: search TEXT";
+        } else {
+            const bool ok = forEachVersion(store, [&](int index, const QJsonObject& entry) {
+                const QString text = entry["text"].toString();
+                const qsizetype pos = text.indexOf(argument);
+                if (pos < 0) return !stream->cancelled.load();
+                return out.write(QString("%1\t%2\t%3\n").arg(index + 1)
+                                 .arg(formatTime(entry["time"].toInteger()))
+                                 .arg(firstLine(text, pos)));
+            });
+            if (!ok) error = store.errorString();
+        }
+    }
+
+    if (!error.isEmpty()) {
+        out.write("error: " + error + "\n");
+    }
+    out.finish();
+    QMetaObject::invokeMethod(this, [this, stream]() { finish(stream); }, Qt::QueuedConnection);
+}
+
+void QueryServer::deliver(const std::shared_ptr<Stream>& stream, const QByteArray& chunk)
+{
+    if (!stream->socket) {
+        stream->credits.release();
+        return;
+    }
+    stream->pending.append(chunk.size());
+    stream->socket->write(chunk);
+}
+
+void QueryServer::finish(const std::shared_ptr<Stream>& stream)
+{
+    // Wartet, bis alles geschrieben ist, danach folgt disconnected()
+    if (stream->socket) stream->socket->disconnectFromServer();
+}
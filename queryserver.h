@@ -0,0 +1,77 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include <QList>
+#include <QJsonObject>
+#include <functional>
+#include <memory>
+#include "historystore.h"
+
+class QLocalSocket;
+
+/**
+ * @brief Beantwortet lesende Abfragen an die laufende Instanz über den lokalen Socket
+ *
+ * Eine Abfrage ist eine Zeile mit abschließendem Zeilenumbruch:
+ *   get-current          Aktueller Text
+ *   get-version N        Text der Version N (ab 1)
+ *   get-at ZEIT          Text der Version, die zur Zeit (ISO 8601) aktuell war
+ *   list-versions        Eine Zeile pro Version: Nummer, Vorgänger, Zeit, Zeichen, erste Zeile
+ *   diff N M             Unterschiede zwischen Version N und M im Unified-Format
+ *   search TEXT          Versionen, die TEXT enthalten, mit der ersten passenden Zeile
+ *   stats                Kennzahlen des Editors als JSON, siehe AllocStats
+ *
+ * Die Antwort ist UTF-8 und endet mit dem Schließen der Verbindung, Fehler
+ * beginnen mit "error: ". Gearbeitet wird in einem eigenen Thread auf einer
+ * Kopie aus HistoryStore::snapshot(), der Editor bleibt dabei bedienbar.
+ * Die Antwort wird in Stücken geschrieben; liest der Client nicht schnell
+ * genug, wartet der Thread, statt die ganze Antwort im Speicher zu sammeln.
+ */
+class QueryServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Stand des Editors zum Zeitpunkt der Abfrage
+     */
+    struct Snapshot {
+        QString currentText;
+        QJsonObject stats;
+        HistoryStore store;         // Leer, solange die History noch lädt
+        int currentIndex = -1;
+        bool historyReady = false;
+    };
+
+    explicit QueryServer(std::function<Snapshot()> snapshotProvider, QObject *parent = nullptr);
+
+    /**
+     * @brief Bricht laufende Abfragen ab und wartet auf den Thread
+     */
+    ~QueryServer();
+
+    /**
+     * @brief Beantwortet eine Abfrage, die Verbindung gehört danach dem Server
+     */
+    void answer(QLocalSocket* client, const QByteArray& request);
+
+private:
+    static const int CHUNK_SIZE = 64 * 1024;
+    static const int MAX_PENDING_CHUNKS = 8;   // Geschrieben, aber vom Client noch nicht gelesen
+
+    struct Stream;
+
+    std::function<Snapshot()> m_snapshotProvider;
+    QThreadPool m_pool;
+    QList<std::shared_ptr<Stream>> m_streams;
+
+    void run(const std::shared_ptr<Stream>& stream, const QByteArray& request, Snapshot& snapshot);
+    void deliver(const std::shared_ptr<Stream>& stream, const QByteArray& chunk);
+    void finish(const std::shared_ptr<Stream>& stream);
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "retention.h"
+#include <algorithm>
+
+RetentionPolicy::RetentionPolicy()
+    : m_enabled(false)
+{
+}
+
+void RetentionPolicy::configure(bool enabled, int keepAllMinutes, int perMinuteHours)
+{
+    const qint64 minute = 60 * 1000;
+    const qint64 hour = 60 * minute;
+    m_enabled = enabled;
+    m_tiers = {
+        {keepAllMinutes * minute, minute},
+        {keepAllMinutes * minute + perMinuteHours * hour, hour}
+    };
+    reset();
+}
+
+void RetentionPolicy::reset()
+{
+    m_marks = QVector<Watermark>(m_tiers.size());
+    m_candidates.clear();
+}
+
+QList<int> RetentionPolicy::removable(const UndoTree& tree, int currentIndex, qint64 now)
+{
+    QList<int> result;
+    if (!m_enabled || m_tiers.isEmpty()) return result;
+
+    // Pro Stufe nur die Versionen, die seit dem letzten Aufruf alt genug
+    // geworden sind. Die Zeitstempel steigen mit dem Index, die erste noch zu
+    // junge Version beendet die Stufe. Die Raster gröberer Stufen enthalten
+    // die feineren, ein Kandidat bleibt daher auch in höheren Stufen einer.
+    for (int t = 0; t < m_tiers.size(); ++t) {
+        Watermark& mark = m_marks[t];
+        for (; mark.next < tree.size(); ++mark.next) {
+            const qint64 time = tree.time(mark.next);
+            if (time <= 0) continue;
+            if (now - time < m_tiers[t].minAgeMs) break;
+
+            const qint64 slot = time / m_tiers[t].intervalMs;
+            if (slot == mark.slot && mark.last >= 0) {
+                m_candidates.append(mark.last);     // Neueste Version des Rasters bleibt
+            }
+            mark.slot = slot;
+            mark.last = mark.next;
+        }
+    }
+    if (m_candidates.size() < BATCH_SIZE) return result;
+
+    std::sort(m_candidates.begin(), m_candidates.end());
+    m_candidates.erase(std::unique(m_candidates.begin(), m_candidates.end()), m_candidates.end());
+    for (int index : m_candidates) {
+        if (index == currentIndex || tree.isLeaf(index)) continue;
+        result.append(index);
+    }
+    return result;
+}
+
+void RetentionPolicy::removed(const QList<int>& indices)
+{
+    // Neuer Index: alter Index abzüglich der davor entfernten, -1 wenn selbst entfernt
+    const auto shift = [&indices](int index) {
+        const auto it = std::lower_bound(indices.begin(), indices.end(), index);
+        if (it != indices.end() && *it == index) return -1;
+        return index - int(it - indices.begin());
+    };
+    for (Watermark& mark : m_marks) {
+        const auto it = std::lower_bound(indices.begin(), indices.end(), mark.next);
+        mark.next -= int(it - indices.begin());
+        if (mark.last >= 0) mark.last = shift(mark.last);
+    }
+    QList<int> candidates;
+    for (int index : m_candidates) {
+        const int shifted = shift(index);
+        if (shifted >= 0) candidates.append(shifted);
+    }
+    m_candidates = candidates;
+}
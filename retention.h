@@ -0,0 +1,84 @@
+#ifndef RETENTION_H
+#define RETENTION_H
+
+#include <QVector>
+#include <QList>
+#include "undotree.h"
+
+/**
+ * @brief Ausdünnen alter History-Versionen nach Altersstufen
+ *
+ * Wie bei Backups bleiben junge Versionen vollständig erhalten, ältere nur
+ * noch stichprobenartig: z.B. alle Versionen der letzten Stunde, eine pro
+ * Minute für den letzten Tag und danach eine pro Stunde. Pro Zeitraster
+ * bleibt jeweils die neueste Version erhalten. Die aktuelle Version, die
+ * Enden aller Zweige und Versionen ohne Zeitstempel werden nie entfernt.
+ *
+ * Gearbeitet wird schrittweise: Pro Stufe merkt sich die Policy, bis zu
+ * welcher Version sie geprüft hat, und betrachtet bei jedem Aufruf nur die
+ * Versionen, die seitdem die Altersgrenze der Stufe überschritten haben.
+ * Entfernte Versionen müssen deshalb mit removed() gemeldet werden.
+ */
+class RetentionPolicy
+{
+public:
+    /**
+     * @brief Versionen, die älter als minAgeMs sind, werden auf eine pro intervalMs reduziert
+     */
+    struct Tier {
+        qint64 minAgeMs;
+        qint64 intervalMs;
+    };
+
+    static const int BATCH_SIZE = 64;   // Erst ab so vielen Kandidaten ausdünnen
+
+    RetentionPolicy();
+
+    /**
+     * @brief Stufen aus den Einstellungen: alle für keepAllMinutes, dann eine pro Minute
+     *        für perMinuteHours Stunden, danach eine pro Stunde
+     */
+    void configure(bool enabled, int keepAllMinutes, int perMinuteHours);
+
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Vergisst den Fortschritt, etwa nach dem Laden oder Leeren der History
+     */
+    void reset();
+
+    /**
+     * @brief Liefert aufsteigend sortiert die Indizes, die entfernt werden dürfen
+     *
+     * Geprüft werden nur Versionen, die seit dem letzten Aufruf eine
+     * Altersgrenze überschritten haben, Kandidaten früherer Aufrufe bleiben
+     * vorgemerkt.
+     * @param tree Baum mit Zeitstempeln aller Versionen
+     * @param currentIndex Aktuell angezeigte Version, bleibt immer erhalten
+     * @param now Aktueller Zeitpunkt in ms seit 1970
+     */
+    QList<int> removable(const UndoTree& tree, int currentIndex, qint64 now);
+
+    /**
+     * @brief Passt den Fortschritt an entfernte Versionen an
+     * @param indices Aufsteigend sortierte Indizes vor dem Entfernen
+     */
+    void removed(const QList<int>& indices);
+
+private:
+    /**
+     * @brief Fortschritt einer Stufe
+     */
+    struct Watermark {
+        int next = 0;       // Erste noch nicht geprüfte Version
+        qint64 slot = -1;   // Raster der zuletzt geprüften Version
+        int last = -1;      // Zuletzt geprüfte Version, -1 wenn entfernt
+    };
+
+    bool m_enabled;
+    QVector<Tier> m_tiers;  // Aufsteigend nach minAgeMs
+    QVector<Watermark> m_marks;
+    QList<int> m_candidates; // Versionen mit neuerer im selben Raster, kann doppelte enthalten
+};
+
+#endif
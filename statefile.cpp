@@ -0,0 +1,74 @@
+#include "statefile.h"
+#include "debouncedwriter.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+
+const quint32 STATE_MAGIC = 0x514e4353;  // "QNCS"
+const quint32 STATE_VERSION = 2;         // Ab 2 mit Zeitpunkt
+
+} // namespace
+
+StateFile::StateFile(const QString& path, QObject *parent)
+    : QObject(parent), m_writer(new DebouncedWriter(DELAY_MS, this)), m_path(path), m_savedAt(0)
+{
+}
+
+StateFile::~StateFile()
+{
+    m_writer->flush();
+}
+
+bool StateFile::read(QString* text, int* cursorPos)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    qint32 cursor = 0;
+    qint64 savedAt = 0;
+    QByteArray data;
+    in >> magic >> version >> cursor >> savedAt >> data;
+    if (in.status() != QDataStream::Ok || magic != STATE_MAGIC || version != STATE_VERSION) {
+        return false;
+    }
+
+    *text = QString::fromUtf8(data);
+    *cursorPos = cursor;
+    m_savedAt = savedAt;
+    return true;
+}
+
+void StateFile::update(const QString& text, int cursorPos)
+{
+    m_savedAt = QDateTime::currentMSecsSinceEpoch();
+    const QString path = m_path;
+    const qint64 savedAt = m_savedAt;
+    m_writer->schedule([path, text, cursorPos, savedAt]() {
+        write(path, text, cursorPos, savedAt);
+    });
+}
+
+void StateFile::flush()
+{
+    m_writer->flush();
+}
+
+void StateFile::write(const QString& path, const QString& text, int cursorPos, qint64 savedAt)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Zustandsdatei kann nicht geschrieben werden:" << file.errorString();
+        return;
+    }
+    QDataStream out(&file);
+    out << STATE_MAGIC << STATE_VERSION << qint32(cursorPos) << savedAt << text.toUtf8();
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "Zustandsdatei kann nicht geschrieben werden:" << file.errorString();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef STATEFILE_H
+#define STATEFILE_H
+
+#include <QObject>
+#include <QString>
+
+class DebouncedWriter;
+
+/**
+ * @brief Zustandsdatei mit aktuellem Text und Cursor für den schnellen Start
+ *
+ * update() merkt sich Text und Cursor nur (implizit geteilt); geschrieben
+ * wird über DebouncedWriter höchstens alle DELAY_MS im Thread-Pool mit
+ * QSaveFile, die Umwandlung nach UTF-8 fällt erst dort an. Mit dem Text wird
+ * die Zeit von update() gespeichert: Ist die aktuelle History-Version
+ * neuer, wurde die Datei vor einem Absturz nicht mehr geschrieben.
+ */
+class StateFile : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DELAY_MS = 500;
+
+    explicit StateFile(const QString& path, QObject *parent = nullptr);
+    ~StateFile();
+
+    /**
+     * @brief Liest Text und Cursor
+     * @return false wenn die Datei fehlt, unvollständig oder veraltet ist
+     */
+    bool read(QString* text, int* cursorPos);
+
+    /**
+     * @brief Plant das Schreiben von Text und Cursor
+     */
+    void update(const QString& text, int cursorPos);
+
+    /**
+     * @brief Schreibt einen ausstehenden Stand sofort im aufrufenden Thread
+     */
+    void flush();
+
+    /**
+     * @brief Zeit des zuletzt gelesenen oder vorgemerkten Stands (ms seit Epoche), sonst 0
+     */
+    qint64 savedAt() const { return m_savedAt; }
+
+private:
+    DebouncedWriter* m_writer;
+    QString m_path;
+    qint64 m_savedAt;
+
+    static void write(const QString& path, const QString& text, int cursorPos, qint64 savedAt);
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "textsearch.h"
+#include "parallel.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define QUICKNOTE_SEARCH_SSE2
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define QUICKNOTE_SEARCH_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+const qsizetype PARALLEL_CHUNK = 1 << 20;   // Zeichen pro Teilaufgabe
+
+/**
+ * @brief Suchbegriff mit beiden Schreibweisen des ersten und letzten Zeichens
+ */
+struct Pattern {
+    QStringView needle;
+    Qt::CaseSensitivity cs;
+    quint16 firstLower, firstUpper, lastLower, lastUpper;
+
+    Pattern(QStringView n, Qt::CaseSensitivity c) : needle(n), cs(c)
+    {
+        const QChar first = n.front();
+        const QChar last = n.back();
+        const bool fold = c == Qt::CaseInsensitive;
+        firstLower = (fold ? first.toLower() : first).unicode();
+        firstUpper = (fold ? first.toUpper() : first).unicode();
+        lastLower = (fold ? last.toLower() : last).unicode();
+        lastUpper = (fold ? last.toUpper() : last).unicode();
+    }
+
+    bool verify(const QChar* at) const
+    {
+        if (cs == Qt::CaseSensitive) {
+            return std::memcmp(at, needle.data(), needle.size() * sizeof(QChar)) == 0;
+        }
+        return QStringView(at, needle.size()).compare(needle, Qt::CaseInsensitive) == 0;
+    }
+
+    bool candidate(const QChar* at) const
+    {
+        const quint16 f = at[0].unicode();
+        const quint16 l = at[needle.size() - 1].unicode();
+        return (f == firstLower || f == firstUpper) && (l == lastLower || l == lastUpper);
+    }
+};
+
+void verifyMask(const Pattern& p, const QChar* data, qsizetype i, quint32 mask, int bytesPerChar,
+                QVector<qsizetype>& out)
+{
+    while (mask) {
+        const int bit = qCountTrailingZeroBits(mask);
+        const qsizetype pos = i + bit / bytesPerChar;
+        if (p.verify(data + pos)) out.append(pos);
+        mask &= ~(((1u << bytesPerChar) - 1) << bit);
+    }
+}
+
+#ifdef QUICKNOTE_SEARCH_AVX2
+bool cpuHasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+QUICKNOTE_SEARCH_AVX2
+qsizetype searchAvx2(const Pattern& p, const QChar* data, qsizetype i, qsizetype end, QVector<qsizetype>& out)
+{
+    const qsizetype m = p.needle.size();
+    const __m256i firstLower = _mm256_set1_epi16(short(p.firstLower));
+    const __m256i firstUpper = _mm256_set1_epi16(short(p.firstUpper));
+    const __m256i lastLower = _mm256_set1_epi16(short(p.lastLower));
+    const __m256i lastUpper = _mm256_set1_epi16(short(p.lastUpper));
+    for (; i + 16 <= end; i += 16) {
+        const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + m - 1));
+        const __m256i first = _mm256_or_si256(_mm256_cmpeq_epi16(head, firstLower), _mm256_cmpeq_epi16(head, firstUpper));
+        const __m256i last = _mm256_or_si256(_mm256_cmpeq_epi16(tail, lastLower), _mm256_cmpeq_epi16(tail, lastUpper));
+        const quint32 mask = quint32(_mm256_movemask_epi8(_mm256_and_si256(first, last)));
+        if (mask) verifyMask(p, data, i, mask, 2, out);
+    }
+    return i;
+}
+#endif
+
+/**
+ * @brief Sucht Anfänge in [from, end), data muss bis end + Länge - 1 lesbar sein
+ */
+void searchRange(const Pattern& p, const QChar* data, qsizetype from, qsizetype end, QVector<qsizetype>& out)
+{
+    qsizetype i = from;
+#ifdef QUICKNOTE_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        i = searchAvx2(p, data, i, end, out);
+    }
+#endif
+#ifdef QUICKNOTE_SEARCH_SSE2
+    const qsizetype m = p.needle.size();
+    const __m128i firstLower = _mm_set1_epi16(short(p.firstLower));
+    const __m128i firstUpper = _mm_set1_epi16(short(p.firstUpper));
+    const __m128i lastLower = _mm_set1_epi16(short(p.lastLower));
+    const __m128i lastUpper = _mm_set1_epi16(short(p.lastUpper));
+    for (; i + 8 <= end; i += 8) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + m - 1));
+        const __m128i first = _mm_or_si128(_mm_cmpeq_epi16(head, firstLower), _mm_cmpeq_epi16(head, firstUpper));
+        const __m128i last = _mm_or_si128(_mm_cmpeq_epi16(tail, lastLower), _mm_cmpeq_epi16(tail, lastUpper));
+        const quint32 mask = quint32(_mm_movemask_epi8(_mm_and_si128(first, last)));
+        if (mask) verifyMask(p, data, i, mask, 2, out);
+    }
+#endif
+    for (; i < end; ++i) {
+        if (p.candidate(data + i) && p.verify(data + i)) out.append(i);
+    }
+}
+
+} // namespace
+
+QVector<qsizetype> TextSearch::findAll(QStringView haystack, QStringView needle, Qt::CaseSensitivity cs,
+                                       qsizetype from, qsizetype to)
+{
+    QVector<qsizetype> result;
+    if (to < 0 || to > haystack.size()) to = haystack.size();
+    from = qMax<qsizetype>(0, from);
+    if (needle.isEmpty()) return result;
+
+    // Letzter möglicher Anfang
+    to = qMin(to, haystack.size() - needle.size() + 1);
+    if (from >= to) return result;
+
+    const Pattern pattern(needle, cs);
+    const QChar* data = haystack.data();
+    const qsizetype length = to - from;
+    if (length < 2 * PARALLEL_CHUNK) {
+        searchRange(pattern, data, from, to, result);
+        return result;
+    }
+
+    // Jeder Teil sucht nur Anfänge im eigenen Abschnitt, liest aber darüber hinaus
+    const int chunks = int((length + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK);
+    QVector<QVector<qsizetype>> found(chunks);
+    parallelFor(chunks, [&](int c) {
+        const qsizetype start = from + c * PARALLEL_CHUNK;
+        searchRange(pattern, data, start, qMin(to, start + PARALLEL_CHUNK), found[c]);
+    });
+    qsizetype total = 0;
+    for (const QVector<qsizetype>& part : found) total += part.size();
+    result.reserve(total);
+    for (const QVector<qsizetype>& part : found) result.append(part);
+    return result;
+}
+
+bool TextSearch::matchesAt(QStringView haystack, qsizetype pos, QStringView needle, Qt::CaseSensitivity cs)
+{
+    if (needle.isEmpty() || pos < 0 || pos + needle.size() > haystack.size()) return false;
+    return Pattern(needle, cs).verify(haystack.data() + pos);
+}
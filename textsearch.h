@@ -0,0 +1,35 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Schnelle Teilstringsuche in UTF-16-Text
+ *
+ * Kandidaten werden mit SIMD (SSE2/AVX2, sonst skalar) gefiltert: erstes und
+ * letztes Zeichen des Suchbegriffs werden gleichzeitig für 8 bzw. 16
+ * Positionen verglichen, nur die Treffer beider Vergleiche werden
+ * vollständig geprüft. Ohne Beachtung der Groß-/Kleinschreibung werden je
+ * Zeichen beide Schreibweisen verglichen.
+ */
+class TextSearch {
+public:
+    /**
+     * @brief Alle Fundstellen von needle, auch überlappende, aufsteigend
+     *
+     * Gesucht werden Anfänge im Bereich [from, to) von haystack; die
+     * Fundstelle selbst darf über to hinausreichen. Große Bereiche werden
+     * parallel durchsucht.
+     * @param to Ende des Bereichs, -1 für das Textende
+     */
+    static QVector<qsizetype> findAll(QStringView haystack, QStringView needle, Qt::CaseSensitivity cs,
+                                      qsizetype from = 0, qsizetype to = -1);
+
+    /**
+     * @brief Prüft, ob needle an Position pos steht
+     */
+    static bool matchesAt(QStringView haystack, qsizetype pos, QStringView needle, Qt::CaseSensitivity cs);
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "timeindex.h"
+#include <algorithm>
+
+namespace {
+
+const quint8 SERIAL_VERSION = 1;
+
+quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+bool readVarint(const char*& p, const char* end, quint64* value)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const quint8 byte = quint8(*p++);
+        result |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool readSigned(const char*& p, const char* end, qint64* value)
+{
+    quint64 raw;
+    if (!readVarint(p, end, &raw)) return false;
+    *value = unzigzag(raw);
+    return true;
+}
+
+} // namespace
+
+TimeIndex::TimeIndex()
+    : m_front(0), m_size(0)
+{
+}
+
+void TimeIndex::clear()
+{
+    m_chunks.clear();
+    m_front = 0;
+    m_size = 0;
+}
+
+void TimeIndex::append(qint64 time)
+{
+    if (m_chunks.isEmpty() || m_chunks.last().count >= CHUNK_ENTRIES) {
+        Chunk chunk;
+        chunk.first = time;
+        chunk.firstMax = m_chunks.isEmpty() ? time : qMax(m_chunks.last().lastMax, time);
+        chunk.last = time;
+        chunk.lastMax = chunk.firstMax;
+        chunk.count = 1;
+        m_chunks.append(chunk);
+    } else {
+        Chunk& chunk = m_chunks.last();
+        appendVarint(chunk.deltas, zigzag(time - chunk.last));
+        chunk.last = time;
+        chunk.lastMax = qMax(chunk.lastMax, time);
+        chunk.count++;
+    }
+    ++m_size;
+}
+
+QVector<qint64> TimeIndex::decode(const Chunk& chunk) const
+{
+    QVector<qint64> times;
+    times.reserve(chunk.count);
+    times.append(chunk.first);
+    const char* p = chunk.deltas.constData();
+    const char* end = p + chunk.deltas.size();
+    qint64 delta;
+    while (times.size() < chunk.count && readSigned(p, end, &delta)) {
+        times.append(times.last() + delta);
+    }
+    return times;
+}
+
+qint64 TimeIndex::at(int index) const
+{
+    if (index < 0 || index >= m_size) return 0;
+    // Alle Abschnitte außer dem letzten sind voll
+    const int position = index + m_front;
+    const QVector<qint64> times = decode(m_chunks[position / CHUNK_ENTRIES]);
+    return times.value(position % CHUNK_ENTRIES);
+}
+
+int TimeIndex::atOrBefore(qint64 time) const
+{
+    // Letzter Abschnitt, der nicht nach time beginnt
+    const auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), time,
+                                     [](qint64 value, const Chunk& chunk) { return value < chunk.firstMax; });
+    if (it == m_chunks.cbegin()) return -1;
+    const Chunk& chunk = *(it - 1);
+
+    const QVector<qint64> times = decode(chunk);
+    qint64 runningMax = chunk.firstMax;
+    int k = 0;
+    while (k + 1 < times.size() && qMax(runningMax, times[k + 1]) <= time) {
+        runningMax = qMax(runningMax, times[++k]);
+    }
+    const int index = int(it - 1 - m_chunks.cbegin()) * CHUNK_ENTRIES + k - m_front;
+    return index >= 0 ? index : -1;
+}
+
+void TimeIndex::removeFirst()
+{
+    if (m_size == 0) return;
+    --m_size;
+    if (++m_front >= m_chunks.first().count) {
+        m_chunks.removeFirst();
+        m_front = 0;
+    }
+}
+
+QVector<qint64> TimeIndex::toVector() const
+{
+    QVector<qint64> result;
+    result.reserve(m_size);
+    for (int c = 0; c < m_chunks.size(); ++c) {
+        const QVector<qint64> times = decode(m_chunks[c]);
+        result.append(times.mid(c == 0 ? m_front : 0));
+    }
+    return result;
+}
+
+void TimeIndex::assign(const QVector<qint64>& times)
+{
+    clear();
+    for (qint64 time : times) append(time);
+}
+
+void TimeIndex::truncate(int size)
+{
+    if (size >= m_size) return;
+    QVector<qint64> times = toVector();
+    times.resize(qMax(0, size));
+    assign(times);
+}
+
+void TimeIndex::remove(const QList<int>& indices)
+{
+    if (indices.isEmpty()) return;
+    const QVector<qint64> times = toVector();
+    QVector<qint64> kept;
+    kept.reserve(times.size());
+    int k = 0;
+    for (int i = 0; i < times.size(); ++i) {
+        while (k < indices.size() && indices[k] < i) ++k;
+        if (k < indices.size() && indices[k] == i) continue;
+        kept.append(times[i]);
+    }
+    assign(kept);
+}
+
+void TimeIndex::replace(int index, qint64 time)
+{
+    if (index < 0 || index >= m_size || at(index) == time) return;
+    QVector<qint64> times = toVector();
+    times[index] = time;
+    assign(times);
+}
+
+/**
+ * Format: u8 Version | Varint Anzahl entfernter Einträge | Varint Abschnitte |
+ * je Abschnitt: Varint Anzahl, ZigZag first, firstMax - first, last - first,
+ * lastMax - firstMax, Varint Länge und die Differenzen unverändert.
+ */
+QByteArray TimeIndex::serialize() const
+{
+    QByteArray out;
+    out.append(char(SERIAL_VERSION));
+    appendVarint(out, quint64(m_front));
+    appendVarint(out, quint64(m_chunks.size()));
+    for (const Chunk& chunk : m_chunks) {
+        appendVarint(out, quint64(chunk.count));
+        appendVarint(out, zigzag(chunk.first));
+        appendVarint(out, zigzag(chunk.firstMax - chunk.first));
+        appendVarint(out, zigzag(chunk.last - chunk.first));
+        appendVarint(out, zigzag(chunk.lastMax - chunk.firstMax));
+        appendVarint(out, quint64(chunk.deltas.size()));
+        out.append(chunk.deltas);
+    }
+    return out;
+}
+
+bool TimeIndex::deserialize(const QByteArray& data, TimeIndex* index)
+{
+    const char* p = data.constData();
+    const char* end = p + data.size();
+    if (p == end || quint8(*p++) != SERIAL_VERSION) return false;
+
+    quint64 front;
+    quint64 chunkCount;
+    if (!readVarint(p, end, &front) || !readVarint(p, end, &chunkCount) || chunkCount > quint64(data.size())) {
+        return false;
+    }
+
+    TimeIndex result;
+    qint64 total = 0;
+    for (quint64 c = 0; c < chunkCount; ++c) {
+        Chunk chunk;
+        quint64 count;
+        quint64 length;
+        qint64 firstMax;
+        qint64 last;
+        qint64 lastMax;
+        if (!readVarint(p, end, &count) || !readSigned(p, end, &chunk.first) || !readSigned(p, end, &firstMax)
+            || !readSigned(p, end, &last) || !readSigned(p, end, &lastMax) || !readVarint(p, end, &length)) {
+            return false;
+        }
+        // Nur der letzte Abschnitt darf unvollständig sein
+        if (count < 1 || count > CHUNK_ENTRIES || (count < CHUNK_ENTRIES && c + 1 < chunkCount)
+            || length > quint64(end - p)) {
+            return false;
+        }
+        chunk.count = int(count);
+        chunk.firstMax = chunk.first + firstMax;
+        chunk.last = chunk.first + last;
+        chunk.lastMax = chunk.firstMax + lastMax;
+        chunk.deltas = QByteArray(p, qsizetype(length));
+        p += length;
+        total += chunk.count;
+        result.m_chunks.append(chunk);
+    }
+    if (p != end || (chunkCount > 0 && front >= quint64(result.m_chunks.first().count)) || (chunkCount == 0 && front > 0)) {
+        return false;
+    }
+    result.m_front = int(front);
+    result.m_size = int(total - qint64(front));
+    *index = result;
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+
+/**
+ * @brief Zeitpunkte aller Versionen, kompakt gespeichert und nach Zeit durchsuchbar
+ *
+ * Die Zeitpunkte (ms seit 1970, 0 = unbekannt) liegen in der Reihenfolge der
+ * Versionen als Differenzen zum Vorgänger vor, jeweils als ZigZag-Varint.
+ * Beim Tippen im Sekundentakt genügen dafür meist zwei bis drei Bytes pro
+ * Version. Alle CHUNK_ENTRIES Versionen beginnt ein Abschnitt mit absolutem
+ * Startwert und dem bis dahin größten Zeitpunkt. atOrBefore() sucht binär
+ * über die Abschnitte und dekodiert danach nur einen Abschnitt.
+ *
+ * Geht die Uhr zwischendurch zurück, zählt der größte bisherige Zeitpunkt:
+ * gefunden wird die letzte Version, vor der noch keine spätere entstanden ist.
+ */
+class TimeIndex
+{
+public:
+    static const int CHUNK_ENTRIES = 64;
+
+    TimeIndex();
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    void clear();
+
+    void append(qint64 time);
+    qint64 at(int index) const;
+
+    /**
+     * @brief Letzte Version, deren Zeitpunkt nicht nach time liegt, oder -1
+     */
+    int atOrBefore(qint64 time) const;
+
+    void removeFirst();
+    void truncate(int size);
+
+    /**
+     * @brief Entfernt beliebige Versionen
+     * @param indices Aufsteigend sortierte Indizes
+     */
+    void remove(const QList<int>& indices);
+    void replace(int index, qint64 time);
+
+    QVector<qint64> toVector() const;
+
+    /**
+     * @brief Kompakte Darstellung für den Index der History-Datei
+     */
+    QByteArray serialize() const;
+    static bool deserialize(const QByteArray& data, TimeIndex* index);
+
+private:
+    struct Chunk {
+        qint64 first = 0;       // Zeitpunkt des ersten Eintrags
+        qint64 firstMax = 0;    // Größter Zeitpunkt bis einschließlich des ersten Eintrags
+        qint64 last = 0;        // Zeitpunkt des letzten Eintrags, Basis für die nächste Differenz
+        qint64 lastMax = 0;     // Größter Zeitpunkt bis einschließlich des letzten Eintrags
+        int count = 0;
+        QByteArray deltas;      // count - 1 Differenzen
+    };
+
+    QVector<Chunk> m_chunks;
+    int m_front;                // Bereits entfernte Einträge im ersten Abschnitt
+    int m_size;
+
+    void assign(const QVector<qint64>& times);
+    QVector<qint64> decode(const Chunk& chunk) const;
+};
+
+#endif
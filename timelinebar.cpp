@@ -0,0 +1,84 @@
+#include "timelinebar.h"
+#include "translations.h"
+#include <QHBoxLayout>
+
+TimelineBar::TimelineBar(QWidget *parent)
+    : QWidget(parent), m_pending(-1), m_rendered(-1)
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(6, 2, 6, 2);
+
+    m_slider = new QSlider(Qt::Horizontal, this);
+    m_slider->setRange(0, 0);
+    m_label = new QLabel(this);
+    layout->addWidget(m_slider, 1);
+    layout->addWidget(m_label);
+
+    // Werte sammeln, gezeichnet wird im Frame-Takt
+    m_frameTimer.setInterval(FRAME_INTERVAL_MS);
+    connect(&m_frameTimer, &QTimer::timeout, this, [this]() {
+        if (m_pending < 0 || m_pending == m_rendered) {
+            m_frameTimer.stop();
+            return;
+        }
+        m_rendered = m_pending;
+        emit scrubbed(m_rendered);
+    });
+
+    m_commitTimer.setSingleShot(true);
+    m_commitTimer.setInterval(KEYBOARD_COMMIT_MS);
+    connect(&m_commitTimer, &QTimer::timeout, this, &TimelineBar::commit);
+
+    connect(m_slider, &QSlider::valueChanged, this, [this](int value) {
+        m_pending = value;
+        updateLabel();
+        if (!m_frameTimer.isActive()) {
+            // Erste Änderung sofort zeigen, weitere im Frame-Takt
+            m_rendered = m_pending;
+            emit scrubbed(m_rendered);
+            m_frameTimer.start();
+        }
+        if (!m_slider->isSliderDown()) {
+            m_commitTimer.start();
+        }
+    });
+    connect(m_slider, &QSlider::sliderReleased, this, &TimelineBar::commit);
+
+    updateLabel();
+}
+
+void TimelineBar::setRange(int versionCount, int currentIndex)
+{
+    const bool blocked = m_slider->blockSignals(true);
+    m_slider->setRange(0, qMax(0, versionCount - 1));
+    m_slider->setValue(qMax(0, currentIndex));
+    m_slider->blockSignals(blocked);
+    m_pending = -1;
+    m_rendered = -1;
+    m_frameTimer.stop();
+    m_commitTimer.stop();
+    updateLabel();
+}
+
+void TimelineBar::updateLabel()
+{
+    m_label->setText(QString("%1 %2 / %3").arg(Translations::get("version"))
+                         .arg(m_slider->value() + 1).arg(m_slider->maximum() + 1));
+}
+
+void TimelineBar::commit()
+{
+    m_commitTimer.stop();
+    if (m_pending < 0) return;
+
+    // Letzten Stand zeichnen, falls der Frame-Takt noch aussteht
+    if (m_pending != m_rendered) {
+        m_rendered = m_pending;
+        emit scrubbed(m_rendered);
+    }
+    m_frameTimer.stop();
+    const int index = m_pending;
+    m_pending = -1;
+    m_rendered = -1;
+    emit committed(index);
+}
@@ -0,0 +1,48 @@
+#ifndef TIMELINEBAR_H
+#define TIMELINEBAR_H
+
+#include <QWidget>
+#include <QSlider>
+#include <QLabel>
+#include <QTimer>
+
+/**
+ * @brief Zeitleiste zum Durchfahren der History-Versionen
+ *
+ * Während des Ziehens wird höchstens einmal pro Frame scrubbed() ausgelöst,
+ * egal wie viele Werte der Schieberegler liefert. Erst beim Loslassen (oder
+ * kurz nach der letzten Tastatureingabe) wird die Version mit committed()
+ * übernommen.
+ */
+class TimelineBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimelineBar(QWidget *parent = nullptr);
+
+    /**
+     * @brief Setzt Anzahl der Versionen und die angezeigte Version, ohne Signale auszulösen
+     */
+    void setRange(int versionCount, int currentIndex);
+
+signals:
+    void scrubbed(int index);
+    void committed(int index);
+
+private:
+    static const int FRAME_INTERVAL_MS = 16;     // Höchstens ca. 60 Bilder pro Sekunde
+    static const int KEYBOARD_COMMIT_MS = 400;   // Übernahme nach Tastatureingaben
+
+    QSlider* m_slider;
+    QLabel* m_label;
+    QTimer m_frameTimer;
+    QTimer m_commitTimer;
+    int m_pending;      // Ausgewählt, aber noch nicht übernommen
+    int m_rendered;     // Zuletzt mit scrubbed() gemeldet
+
+    void updateLabel();
+    void commit();
+};
+
+#endif
@@ -46,7 +46,44 @@ const QMap<QString, QString> Translations::englishTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "Font Size"},
-    {"shortcut_settings", "Shortcut Settings"}
+    {"shortcut_settings", "Shortcut Settings"},
+    {"compare_versions", "Compare Versions..."},
+    {"version", "Version"},
+    {"no_differences", "No differences"},
+    {"branches", "Branches"},
+    {"branch", "Branch"},
+    {"timeline", "Timeline"},
+    {"hibernate_after", "Free memory when hidden after"},
+    {"never", "Never"},
+    {"pasting", "Pasting text..."},
+    {"cancel", "Cancel"},
+    {"retention", "Thin out old versions"},
+    {"retention_keep_all", "Keep all versions for"},
+    {"retention_per_minute", "Then one per minute for"},
+    {"retention_per_hour", "Older versions: one per hour"},
+    {"lines", "Lines"},
+    {"sort_lines", "Sort lines"},
+    {"unique_lines", "Remove duplicate lines"},
+    {"filter_lines", "Filter lines..."},
+    {"reverse_lines", "Reverse lines"},
+    {"filter_pattern", "Regular expression:"},
+    {"filter_remove", "Remove matching lines instead of keeping them"},
+    {"invalid_regex", "Invalid regular expression"},
+    {"find", "Find"},
+    {"replace", "Replace"},
+    {"replace_all", "Replace all"},
+    {"match_case", "Match case"},
+    {"no_matches", "No matches"},
+    {"restore_to_time", "Restore to time…"},
+    {"no_version_at_time", "No version existed at that time"},
+    {"word_completion", "Word completion (accept with Tab)"},
+    {"completion_from_history", "Also suggest words from older versions"},
+    {"go_to_line", "Go to line"},
+    {"line", "Line"},
+    {"line_column", "Ln %1, Col %2"},
+    {"characters_count", "%1 characters"},
+    {"show_status_bar", "Show status bar"},
+    {"mirror_file", "Keep a plain-text copy of the note"}
 };
 
 const QMap<QString, QString> Translations::germanTranslations = {
@@ -68,7 +105,44 @@ const QMap<QString, QString> Translations::germanTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "Schriftgröße"},
-    {"shortcut_settings", "Shortcut Einstellungen"}
+    {"shortcut_settings", "Shortcut Einstellungen"},
+    {"compare_versions", "Versionen vergleichen..."},
+    {"version", "Version"},
+    {"no_differences", "Keine Unterschiede"},
+    {"branches", "Zweige"},
+    {"branch", "Zweig"},
+    {"timeline", "Zeitleiste"},
+    {"hibernate_after", "Speicher freigeben, wenn versteckt nach"},
+    {"never", "Nie"},
+    {"pasting", "Text wird eingefügt..."},
+    {"cancel", "Abbrechen"},
+    {"retention", "Alte Versionen ausdünnen"},
+    {"retention_keep_all", "Alle Versionen behalten für"},
+    {"retention_per_minute", "Danach eine pro Minute für"},
+    {"retention_per_hour", "Ältere Versionen: eine pro Stunde"},
+    {"lines", "Zeilen"},
+    {"sort_lines", "Zeilen sortieren"},
+    {"unique_lines", "Doppelte Zeilen entfernen"},
+    {"filter_lines", "Zeilen filtern..."},
+    {"reverse_lines", "Zeilenfolge umkehren"},
+    {"filter_pattern", "Regulärer Ausdruck:"},
+    {"filter_remove", "Passende Zeilen entfernen statt behalten"},
+    {"invalid_regex", "Ungültiger regulärer Ausdruck"},
+    {"find", "Suchen"},
+    {"replace", "Ersetzen"},
+    {"replace_all", "Alle ersetzen"},
+    {"match_case", "Groß-/Kleinschreibung"},
+    {"no_matches", "Keine Treffer"},
+    {"restore_to_time", "Stand von…"},
+    {"no_version_at_time", "Zu diesem Zeitpunkt gab es noch keine Version"},
+    {"word_completion", "Wortvervollständigung (mit Tab übernehmen)"},
+    {"completion_from_history", "Auch Wörter aus älteren Versionen vorschlagen"},
+    {"go_to_line", "Gehe zu Zeile"},
+    {"line", "Zeile"},
+    {"line_column", "Z. %1, Sp. %2"},
+    {"characters_count", "%1 Zeichen"},
+    {"show_status_bar", "Statusleiste anzeigen"},
+    {"mirror_file", "Kopie der Notiz als reinen Text führen"}
 };
 
 const QMap<QString, QString> Translations::frenchTranslations = {
@@ -90,7 +164,44 @@ const QMap<QString, QString> Translations::frenchTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "Taille de police"},
-    {"shortcut_settings", "Paramètres de raccourci"}
+    {"shortcut_settings", "Paramètres de raccourci"},
+    {"compare_versions", "Comparer les versions..."},
+    {"version", "Version"},
+    {"no_differences", "Aucune différence"},
+    {"branches", "Branches"},
+    {"branch", "Branche"},
+    {"timeline", "Chronologie"},
+    {"hibernate_after", "Libérer la mémoire après masquage de"},
+    {"never", "Jamais"},
+    {"pasting", "Collage du texte..."},
+    {"cancel", "Annuler"},
+    {"retention", "Alléger les anciennes versions"},
+    {"retention_keep_all", "Garder toutes les versions pendant"},
+    {"retention_per_minute", "Puis une par minute pendant"},
+    {"retention_per_hour", "Versions plus anciennes : une par heure"},
+    {"lines", "Lignes"},
+    {"sort_lines", "Trier les lignes"},
+    {"unique_lines", "Supprimer les lignes en double"},
+    {"filter_lines", "Filtrer les lignes..."},
+    {"reverse_lines", "Inverser les lignes"},
+    {"filter_pattern", "Expression régulière :"},
+    {"filter_remove", "Supprimer les lignes correspondantes au lieu de les garder"},
+    {"invalid_regex", "Expression régulière invalide"},
+    {"find", "Rechercher"},
+    {"replace", "Remplacer"},
+    {"replace_all", "Tout remplacer"},
+    {"match_case", "Respecter la casse"},
+    {"no_matches", "Aucun résultat"},
+    {"restore_to_time", "Restaurer à une date…"},
+    {"no_version_at_time", "Aucune version n'existait à ce moment"},
+    {"word_completion", "Complétion des mots (accepter avec Tab)"},
+    {"completion_from_history", "Proposer aussi les mots des anciennes versions"},
+    {"go_to_line", "Aller à la ligne"},
+    {"line", "Ligne"},
+    {"line_column", "Ln %1, Col %2"},
+    {"characters_count", "%1 caractères"},
+    {"show_status_bar", "Afficher la barre d'état"},
+    {"mirror_file", "Conserver une copie en texte brut de la note"}
 };
 
 const QMap<QString, QString> Translations::spanishTranslations = {
@@ -112,7 +223,44 @@ const QMap<QString, QString> Translations::spanishTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "Tamaño de fuente"},
-    {"shortcut_settings", "Configuración de atajos"}
+    {"shortcut_settings", "Configuración de atajos"},
+    {"compare_versions", "Comparar versiones..."},
+    {"version", "Versión"},
+    {"no_differences", "Sin diferencias"},
+    {"branches", "Ramas"},
+    {"branch", "Rama"},
+    {"timeline", "Línea de tiempo"},
+    {"hibernate_after", "Liberar memoria tras ocultar durante"},
+    {"never", "Nunca"},
+    {"pasting", "Pegando texto..."},
+    {"cancel", "Cancelar"},
+    {"retention", "Reducir versiones antiguas"},
+    {"retention_keep_all", "Conservar todas las versiones durante"},
+    {"retention_per_minute", "Después una por minuto durante"},
+    {"retention_per_hour", "Versiones más antiguas: una por hora"},
+    {"lines", "Líneas"},
+    {"sort_lines", "Ordenar líneas"},
+    {"unique_lines", "Eliminar líneas duplicadas"},
+    {"filter_lines", "Filtrar líneas..."},
+    {"reverse_lines", "Invertir líneas"},
+    {"filter_pattern", "Expresión regular:"},
+    {"filter_remove", "Eliminar las líneas coincidentes en lugar de conservarlas"},
+    {"invalid_regex", "Expresión regular no válida"},
+    {"find", "Buscar"},
+    {"replace", "Reemplazar"},
+    {"replace_all", "Reemplazar todo"},
+    {"match_case", "Distinguir mayúsculas"},
+    {"no_matches", "Sin coincidencias"},
+    {"restore_to_time", "Restaurar a una fecha…"},
+    {"no_version_at_time", "No existía ninguna versión en ese momento"},
+    {"word_completion", "Autocompletado de palabras (aceptar con Tab)"},
+    {"completion_from_history", "Sugerir también palabras de versiones anteriores"},
+    {"go_to_line", "Ir a la línea"},
+    {"line", "Línea"},
+    {"line_column", "Lín. %1, Col. %2"},
+    {"characters_count", "%1 caracteres"},
+    {"show_status_bar", "Mostrar barra de estado"},
+    {"mirror_file", "Mantener una copia en texto plano de la nota"}
 };
 
 const QMap<QString, QString> Translations::italianTranslations = {
@@ -134,7 +282,44 @@ const QMap<QString, QString> Translations::italianTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "Dimensione del carattere"},
-    {"shortcut_settings", "Impostazioni scorciatoie"}
+    {"shortcut_settings", "Impostazioni scorciatoie"},
+    {"compare_versions", "Confronta versioni..."},
+    {"version", "Versione"},
+    {"no_differences", "Nessuna differenza"},
+    {"branches", "Rami"},
+    {"branch", "Ramo"},
+    {"timeline", "Cronologia"},
+    {"hibernate_after", "Libera memoria se nascosto da"},
+    {"never", "Mai"},
+    {"pasting", "Incollamento del testo..."},
+    {"cancel", "Annulla"},
+    {"retention", "Sfoltire le versioni vecchie"},
+    {"retention_keep_all", "Conserva tutte le versioni per"},
+    {"retention_per_minute", "Poi una al minuto per"},
+    {"retention_per_hour", "Versioni più vecchie: una all'ora"},
+    {"lines", "Righe"},
+    {"sort_lines", "Ordina righe"},
+    {"unique_lines", "Rimuovi righe duplicate"},
+    {"filter_lines", "Filtra righe..."},
+    {"reverse_lines", "Inverti righe"},
+    {"filter_pattern", "Espressione regolare:"},
+    {"filter_remove", "Rimuovi le righe corrispondenti invece di mantenerle"},
+    {"invalid_regex", "Espressione regolare non valida"},
+    {"find", "Trova"},
+    {"replace", "Sostituisci"},
+    {"replace_all", "Sostituisci tutto"},
+    {"match_case", "Maiuscole/minuscole"},
+    {"no_matches", "Nessun risultato"},
+    {"restore_to_time", "Ripristina a una data…"},
+    {"no_version_at_time", "In quel momento non esisteva alcuna versione"},
+    {"word_completion", "Completamento parole (accetta con Tab)"},
+    {"completion_from_history", "Suggerisci anche parole dalle versioni precedenti"},
+    {"go_to_line", "Vai alla riga"},
+    {"line", "Riga"},
+    {"line_column", "Riga %1, Col %2"},
+    {"characters_count", "%1 caratteri"},
+    {"show_status_bar", "Mostra barra di stato"},
+    {"mirror_file", "Mantieni una copia in testo semplice della nota"}
 };
 
 const QMap<QString, QString> Translations::chineseTranslations = {
@@ -156,5 +341,42 @@ const QMap<QString, QString> Translations::chineseTranslations = {
     {"italian", "Italiano"},
     {"chinese", "中文"},
     {"font_size", "字体大小"},
-    {"shortcut_settings", "快捷键设置"}
+    {"shortcut_settings", "快捷键设置"},
+    {"compare_versions", "比较版本..."},
+    {"version", "版本"},
+    {"no_differences", "没有差异"},
+    {"branches", "分支"},
+    {"branch", "分支"},
+    {"timeline", "时间轴"},
+    {"hibernate_after", "隐藏后释放内存时间"},
+    {"never", "从不"},
+    {"pasting", "正在粘贴文本..."},
+    {"cancel", "取消"},
+    {"retention", "精简旧版本"},
+    {"retention_keep_all", "保留所有版本"},
+    {"retention_per_minute", "之后每分钟保留一个，持续"},
+    {"retention_per_hour", "更早的版本：每小时一个"},
+    {"lines", "行"},
+    {"sort_lines", "排序行"},
+    {"unique_lines", "删除重复行"},
+    {"filter_lines", "筛选行..."},
+    {"reverse_lines", "反转行顺序"},
+    {"filter_pattern", "正则表达式："},
+    {"filter_remove", "删除匹配的行而不是保留"},
+    {"invalid_regex", "无效的正则表达式"},
+    {"find", "查找"},
+    {"replace", "替换"},
+    {"replace_all", "全部替换"},
+    {"match_case", "区分大小写"},
+    {"no_matches", "无匹配"},
+    {"restore_to_time", "恢复到某个时间…"},
+    {"no_version_at_time", "该时间尚无版本"},
+    {"word_completion", "单词补全（按 Tab 接受）"},
+    {"completion_from_history", "同时建议旧版本中的单词"},
+    {"go_to_line", "转到行"},
+    {"line", "行"},
+    {"line_column", "行 %1，列 %2"},
+    {"characters_count", "%1 个字符"},
+    {"show_status_bar", "显示状态栏"},
+    {"mirror_file", "保留笔记的纯文本副本"}
 }; 
\ No newline at end of file
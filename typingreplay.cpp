@@ -0,0 +1,218 @@
+#include "typingreplay.h"
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTextCursor>
+#include <QTextStream>
+#include <QDebug>
+#include "allocstats.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * @param unit Endung der Schlüssel und Einheit in der Ausgabe, leer für Anzahlen
+ * @param scale Teiler für die Werte, 1000 für Nanosekunden in Mikrosekunden
+ */
+QJsonObject percentiles(QVector<qint64> values, const QString& unit = "us", double scale = 1000.0)
+{
+    QJsonObject result;
+    if (values.isEmpty()) return result;
+    std::sort(values.begin(), values.end());
+
+    const auto at = [&values, scale](double p) {
+        const int index = qMin(int(values.size()) - 1, int(p * values.size()));
+        return values[index] / scale;
+    };
+    const auto key = [&unit](const char* name) { return unit.isEmpty() ? QString(name) : QString(name) + "_" + unit; };
+    qint64 sum = 0;
+    for (qint64 v : values) sum += v;
+
+    result[key("p50")] = at(0.50);
+    result[key("p90")] = at(0.90);
+    result[key("p99")] = at(0.99);
+    result[key("max")] = values.last() / scale;
+    result[key("mean")] = sum / scale / values.size();
+    return result;
+}
+
+QString formatLine(const QString& name, const QJsonObject& stats, const QString& unit = "us")
+{
+    const auto key = [&unit](const char* name) { return unit.isEmpty() ? QString(name) : QString(name) + "_" + unit; };
+    const QString suffix = unit.isEmpty() ? QString() : " " + unit;
+    return QString("%1  p50 %2%7  p90 %3%7  p99 %4%7  max %5%7  mean %6%7")
+        .arg(name, -6)
+        .arg(stats[key("p50")].toDouble(), 0, 'f', 0)
+        .arg(stats[key("p90")].toDouble(), 0, 'f', 0)
+        .arg(stats[key("p99")].toDouble(), 0, 'f', 0)
+        .arg(stats[key("max")].toDouble(), 0, 'f', 0)
+        .arg(stats[key("mean")].toDouble(), 0, 'f', 1)
+        .arg(suffix);
+}
+
+} // namespace
+
+TypingReplay::TypingReplay(QTextEdit* target, const Options& options, QObject* parent)
+    : QObject(parent), m_target(target), m_options(options), m_next(0)
+{
+}
+
+QString TypingReplay::syntheticText(int length, quint32 seed)
+{
+    static const char* const words[] = {
+        "note", "meeting", "todo", "call", "project", "review", "the", "and", "with", "for",
+        "release", "server", "config", "check", "tomorrow", "idea", "list", "fix", "a", "to"
+    };
+    const int wordCount = sizeof(words) / sizeof(words[0]);
+
+    QRandomGenerator random(seed);
+    QString text;
+    text.reserve(length + 16);
+    int lineLength = 0;
+    while (text.size() < length) {
+        const QString word = QString::fromLatin1(words[random.bounded(wordCount)]);
+        text += word;
+        lineLength += word.size() + 1;
+        if (lineLength > 40 + int(random.bounded(40))) {
+            text += '\n';
+            lineLength = 0;
+        } else {
+            text += ' ';
+        }
+    }
+    text.truncate(length);
+    return text;
+}
+
+bool TypingReplay::start()
+{
+    if (!m_options.scriptFile.isEmpty()) {
+        QFile file(m_options.scriptFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Aufzeichnung kann nicht geöffnet werden:" << m_options.scriptFile;
+            return false;
+        }
+        m_keys = QString::fromUtf8(file.readAll());
+    } else {
+        // Synthetische Eingabe mit gelegentlichen Korrekturen
+        QRandomGenerator random(4711);
+        const QString text = syntheticText(m_options.keystrokes, 42);
+        for (QChar c : text) {
+            m_keys += c;
+            if (random.bounded(20) == 0) {
+                m_keys += '\b';
+                m_keys += c;
+            }
+        }
+        m_keys.truncate(m_options.keystrokes);
+    }
+
+    QTextCursor cursor = m_target->textCursor();
+    cursor.movePosition(QTextCursor::End);
+    m_target->setTextCursor(cursor);
+    m_target->setFocus();
+
+    m_inputNs.reserve(m_keys.size());
+    m_paintNs.reserve(m_keys.size());
+    m_clock.start();
+    QTimer::singleShot(0, this, &TypingReplay::sendNext);
+    return true;
+}
+
+void TypingReplay::sendNext()
+{
+    if (m_next >= m_keys.size()) {
+        emit finished(report());
+        return;
+    }
+
+    const QChar c = m_keys[m_next++];
+    int key = Qt::Key_unknown;
+    QString text(c);
+    if (c == '\b') {
+        key = Qt::Key_Backspace;
+        text.clear();
+    } else if (c == '\n') {
+        key = Qt::Key_Return;
+        text = "\r";
+    } else if (c == ' ') {
+        key = Qt::Key_Space;
+    } else if (c.unicode() < 128 && c.isLetterOrNumber()) {
+        key = c.toUpper().unicode();
+    }
+
+    QKeyEvent press(QEvent::KeyPress, key, Qt::NoModifier, text);
+    QKeyEvent release(QEvent::KeyRelease, key, Qt::NoModifier, text);
+    const AllocStats::Scope allocations;
+    const qint64 start = m_clock.nsecsElapsed();
+    QCoreApplication::sendEvent(m_target, &press);
+    QCoreApplication::sendEvent(m_target, &release);
+    const qint64 handled = m_clock.nsecsElapsed();
+    const AllocStats::Counters allocated = allocations.elapsed();
+
+    // Layout und Zeichnen erzwingen, wie es die Ereignisschleife als Nächstes täte
+    m_target->viewport()->repaint();
+    const qint64 painted = m_clock.nsecsElapsed();
+
+    m_inputNs.append(handled - start);
+    m_paintNs.append(painted - start);
+    m_allocations.append(qint64(allocated.allocations));
+    m_allocatedBytes.append(qint64(allocated.bytes));
+
+    QTimer::singleShot(m_options.intervalMs, this, &TypingReplay::sendNext);
+}
+
+int TypingReplay::report()
+{
+    QJsonObject result;
+    result["keystrokes"] = int(m_inputNs.size());
+    result["interval_ms"] = m_options.intervalMs;
+    result["final_length"] = int(m_target->document()->characterCount());
+    result["input"] = percentiles(m_inputNs);
+    result["paint"] = percentiles(m_paintNs);
+
+    QTextStream out(stdout);
+    out << "keystrokes " << m_inputNs.size() << ", interval " << m_options.intervalMs
+        << " ms, note length " << result["final_length"].toInt() << Qt::endl;
+    out << formatLine("input", result["input"].toObject()) << Qt::endl;
+    out << formatLine("paint", result["paint"].toObject()) << Qt::endl;
+
+    // Speicheranforderungen je Anschlag gegen die Budgets prüfen
+    int exitCode = 0;
+    const bool budgets = m_options.allocationBudget >= 0 || m_options.byteBudget >= 0;
+    if (AllocStats::enabled()) {
+        const QJsonObject allocations = percentiles(m_allocations, QString(), 1.0);
+        const QJsonObject bytes = percentiles(m_allocatedBytes, "bytes", 1.0);
+        result["allocations"] = allocations;
+        result["allocated"] = bytes;
+        out << formatLine("allocs", allocations, QString()) << Qt::endl;
+        out << formatLine("bytes", bytes, "bytes") << Qt::endl;
+
+        const auto check = [&](const char* what, double p99, qint64 budget) {
+            if (budget < 0 || p99 <= budget) return;
+            out << "budget exceeded: p99 " << what << " per keystroke " << qint64(p99)
+                << " > " << budget << Qt::endl;
+            exitCode = 2;
+        };
+        check("allocations", allocations["p99"].toDouble(), m_options.allocationBudget);
+        check("bytes", bytes["p99_bytes"].toDouble(), m_options.byteBudget);
+    } else if (budgets) {
+        out << "allocation budgets need a build with QUICKNOTE_ALLOC_STATS=ON" << Qt::endl;
+        exitCode = 1;
+    }
+    result["budget_exceeded"] = exitCode == 2;
+
+    if (!m_options.reportFile.isEmpty()) {
+        QFile file(m_options.reportFile);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(result).toJson());
+        } else {
+            qDebug() << "Bericht kann nicht geschrieben werden:" << m_options.reportFile;
+        }
+    }
+    return exitCode;
+}
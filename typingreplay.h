@@ -0,0 +1,74 @@
+#ifndef TYPINGREPLAY_H
+#define TYPINGREPLAY_H
+
+#include <QObject>
+#include <QTextEdit>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QString>
+
+/**
+ * @brief Spielt Tastenanschläge gegen ein Textfeld ab und misst die Latenz
+ *
+ * Jeder Anschlag wird als KeyPress/KeyRelease an das Textfeld geschickt,
+ * danach wird das Textfeld synchron neu gezeichnet. Gemessen wird die Zeit
+ * bis zum Ende der Tastenverarbeitung (inklusive textChanged, Formatierung
+ * und Speichern der History) und bis zum Ende des Zeichnens.
+ *
+ * Mit der Build-Option QUICKNOTE_ALLOC_STATS werden zusätzlich die
+ * Speicheranforderungen je Anschlag gezählt. Überschreitet ihr p99 ein
+ * gesetztes Budget, endet der Lauf mit Exit-Code 2.
+ *
+ * Gedacht für Läufe mit QT_QPA_PLATFORM=offscreen über "quicknote --replay-typing".
+ */
+class TypingReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString scriptFile;     // Aufgezeichnete Eingabe (UTF-8), leer = synthetisch
+        int keystrokes = 2000;  // Anzahl synthetischer Anschläge
+        int intervalMs = 0;     // Abstand zwischen Anschlägen, 0 = so schnell wie möglich
+        QString reportFile;     // Optionaler JSON-Bericht
+        qint64 allocationBudget = -1;   // Höchstens so viele Anforderungen je Anschlag (p99), -1 = ohne
+        qint64 byteBudget = -1;         // Höchstens so viele Bytes je Anschlag (p99), -1 = ohne
+    };
+
+    TypingReplay(QTextEdit* target, const Options& options, QObject* parent = nullptr);
+
+    /**
+     * @brief Erzeugt einen synthetischen Notiztext mit ungefähr der angegebenen Länge
+     */
+    static QString syntheticText(int length, quint32 seed);
+
+    /**
+     * @brief Startet die Wiedergabe, am Ende wird finished() ausgelöst
+     * @return false wenn die Aufzeichnung nicht gelesen werden konnte
+     */
+    bool start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void sendNext();
+
+private:
+    QTextEdit* m_target;
+    Options m_options;
+    QString m_keys;             // Abzuspielende Zeichen, '\b' steht für Rücktaste
+    int m_next;
+    QElapsedTimer m_clock;
+    QVector<qint64> m_inputNs;  // Bis zum Ende der Tastenverarbeitung
+    QVector<qint64> m_paintNs;  // Bis zum Ende des Zeichnens
+    QVector<qint64> m_allocations;      // Anforderungen je Anschlag bis zum Ende der Tastenverarbeitung
+    QVector<qint64> m_allocatedBytes;
+
+    /**
+     * @brief Gibt die Ergebnisse aus und liefert den Exit-Code
+     */
+    int report();
+};
+
+#endif
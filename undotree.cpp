@@ -0,0 +1,204 @@
+#include "undotree.h"
+
+UndoTree::UndoTree()
+    : m_front(0), m_nextId(0), m_needsMigration(false)
+{
+}
+
+void UndoTree::clear()
+{
+    m_nodes.clear();
+    m_positions.clear();
+    m_front = 0;
+    m_nextId = 0;
+    m_needsMigration = false;
+}
+
+void UndoTree::append(int parent, qint64 id, qint64 time)
+{
+    Node node;
+    node.id = id;
+    node.time = time;
+    const int pos = m_nodes.size();
+    if (parent >= 0 && parent < size()) {
+        node.parent = position(parent);
+        Node& parentNode = m_nodes[node.parent];
+        parentNode.children.append(pos);
+        parentNode.activeChild = pos;
+    }
+    m_nodes.append(node);
+    m_positions.insert(id, pos);
+    m_nextId = qMax(m_nextId, id + 1);
+}
+
+void UndoTree::appendEntry(const QJsonObject& entry)
+{
+    const int index = size();
+    const qint64 time = entry["time"].toInteger();
+
+    if (entry.contains("id")) {
+        const qint64 parentId = entry["parentId"].toInteger(-1);
+        const int parentPos = m_positions.value(parentId, -1);
+        append(parentPos >= 0 ? indexOf(parentPos) : -1, entry["id"].toInteger(), time);
+        return;
+    }
+
+    // Ältere Formate: Abstand zum Vorgänger oder lineare History
+    m_needsMigration = true;
+    int parent = index - 1;
+    if (entry.contains("parent")) {
+        const int distance = entry["parent"].toInt();
+        parent = distance > 0 ? index - distance : -1;
+    }
+    append(parent, m_nextId, time);
+}
+
+void UndoTree::storeLinks(QJsonObject& entry, qint64 id, qint64 parentId, qint64 time)
+{
+    entry.remove("parent");
+    entry["id"] = id;
+    entry["parentId"] = parentId;
+    if (time > 0) {
+        entry["time"] = time;
+    }
+}
+
+void UndoTree::removeFirst()
+{
+    if (size() == 0) return;
+    m_positions.remove(m_nodes[m_front].id);
+    ++m_front;
+
+    // Entfernte Knoten erst gesammelt aus dem Vektor löschen
+    if (m_front > 64 && m_front * 2 > m_nodes.size()) {
+        compact();
+    }
+}
+
+void UndoTree::compact()
+{
+    if (m_front == 0) return;
+    const auto shift = [this](int pos) { return pos >= m_front ? pos - m_front : -1; };
+    m_nodes.remove(0, m_front);
+    for (Node& node : m_nodes) {
+        node.parent = shift(node.parent);
+        node.activeChild = shift(node.activeChild);
+        for (int& child : node.children) child = shift(child);
+    }
+    for (auto it = m_positions.begin(); it != m_positions.end(); ++it) {
+        it.value() -= m_front;
+    }
+    m_front = 0;
+}
+
+QList<QPair<int, qint64>> UndoTree::remove(const QList<int>& indices)
+{
+    compact();
+    QVector<bool> removed(m_nodes.size(), false);
+    for (int index : indices) {
+        if (index >= 0 && index < m_nodes.size()) removed[index] = true;
+    }
+
+    // Neue Positionen der verbleibenden Knoten
+    QVector<int> newPos(m_nodes.size(), -1);
+    int count = 0;
+    for (int p = 0; p < m_nodes.size(); ++p) {
+        if (!removed[p]) newPos[p] = count++;
+    }
+
+    QVector<Node> nodes;
+    nodes.reserve(count);
+    QList<QPair<int, qint64>> reparented;
+    for (int p = 0; p < m_nodes.size(); ++p) {
+        if (removed[p]) continue;
+        const int oldParent = m_nodes[p].parent;
+        int parent = oldParent;
+        while (parent >= 0 && removed[parent]) parent = m_nodes[parent].parent;
+
+        Node node;
+        node.id = m_nodes[p].id;
+        node.time = m_nodes[p].time;
+        node.parent = parent >= 0 ? newPos[parent] : -1;
+        if (parent != oldParent) {
+            reparented.append({newPos[p], parent >= 0 ? m_nodes[parent].id : -1});
+        }
+        nodes.append(node);
+    }
+
+    m_positions.clear();
+    for (int p = 0; p < nodes.size(); ++p) {
+        m_positions.insert(nodes[p].id, p);
+        if (nodes[p].parent >= 0) {
+            Node& parentNode = nodes[nodes[p].parent];
+            parentNode.children.append(p);
+            parentNode.activeChild = p;
+        }
+    }
+
+    // Aktive Nachfolger erhalten, an entfernten Knoten deren aktivem Nachfolger folgen
+    for (int p = 0; p < m_nodes.size(); ++p) {
+        if (removed[p]) continue;
+        int child = m_nodes[p].activeChild;
+        while (child >= 0 && removed[child]) child = m_nodes[child].activeChild;
+        if (child >= 0) nodes[newPos[p]].activeChild = newPos[child];
+    }
+    m_nodes = nodes;
+    return reparented;
+}
+
+int UndoTree::parent(int index) const
+{
+    if (index < 0 || index >= size()) return -1;
+    return indexOf(m_nodes[position(index)].parent);
+}
+
+qint64 UndoTree::parentId(int index) const
+{
+    const int parentIndex = parent(index);
+    return parentIndex >= 0 ? id(parentIndex) : -1;
+}
+
+int UndoTree::redoTarget(int index) const
+{
+    if (index < 0 || index >= size()) return -1;
+    return indexOf(m_nodes[position(index)].activeChild);
+}
+
+void UndoTree::activatePath(int index)
+{
+    int pos = index >= 0 && index < size() ? position(index) : -1;
+    while (pos >= m_front) {
+        const int parentPos = m_nodes[pos].parent;
+        if (parentPos < m_front) break;
+        m_nodes[parentPos].activeChild = pos;
+        pos = parentPos;
+    }
+}
+
+int UndoTree::tip(int index) const
+{
+    int next;
+    while ((next = redoTarget(index)) >= 0) {
+        index = next;
+    }
+    return index;
+}
+
+QList<int> UndoTree::branchesAt(int index, int* branch) const
+{
+    QList<int> result;
+    if (index < 0 || index >= size()) return result;
+
+    // Nach oben bis zum ersten Vorgänger mit mehreren Nachfolgern
+    int pos = position(index);
+    while (m_nodes[pos].parent >= m_front) {
+        const Node& parentNode = m_nodes[m_nodes[pos].parent];
+        if (parentNode.children.size() > 1) {
+            for (int child : parentNode.children) result.append(indexOf(child));
+            if (branch) *branch = indexOf(pos);
+            return result;
+        }
+        pos = m_nodes[pos].parent;
+    }
+    return result;
+}
@@ -0,0 +1,123 @@
+#ifndef UNDOTREE_H
+#define UNDOTREE_H
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QJsonObject>
+
+/**
+ * @brief Baumstruktur über den History-Einträgen für verzweigtes Undo/Redo
+ *
+ * Die Einträge bleiben in der Reihenfolge ihres Entstehens im HistoryStore.
+ * Jeder Eintrag verweist auf seinen Vorgänger, gemeinsame Vorfahren werden
+ * dadurch von allen Zweigen geteilt. Ein Zweig kostet nur seine eigenen
+ * Einträge. Undo folgt dem Vorgänger, Redo dem zuletzt aktiven Nachfolger,
+ * beides in O(1).
+ *
+ * In der Datei trägt jeder Eintrag eine fortlaufende Kennung "id" und die
+ * Kennung seines Vorgängers "parentId" (-1 = Wurzel). Dazu kommt der
+ * Zeitpunkt "time" in Millisekunden seit 1970, 0 wenn unbekannt. Ältere
+ * Einträge mit Abstand im Feld "parent" oder ganz ohne Verweis (lineare
+ * History) werden gelesen; needsMigration() meldet dann, dass die Einträge
+ * neu geschrieben werden sollten.
+ */
+class UndoTree
+{
+public:
+    UndoTree();
+
+    void clear();
+    int size() const { return m_nodes.size() - m_front; }
+
+    /**
+     * @brief Fügt einen Knoten am Ende hinzu und macht ihn zum aktiven Nachfolger
+     * @param parent Index des Vorgängers oder -1 für eine Wurzel
+     * @param id Kennung des Eintrags, siehe nextId()
+     * @param time Zeitpunkt des Eintrags in ms seit 1970
+     */
+    void append(int parent, qint64 id, qint64 time);
+
+    /**
+     * @brief Fügt einen Knoten anhand eines gespeicherten Eintrags hinzu
+     */
+    void appendEntry(const QJsonObject& entry);
+
+    /**
+     * @brief true wenn gelesene Einträge noch keine Kennung hatten
+     */
+    bool needsMigration() const { return m_needsMigration; }
+
+    /**
+     * @brief Entfernt den ältesten Knoten, seine Nachfolger werden zu Wurzeln
+     */
+    void removeFirst();
+
+    /**
+     * @brief Entfernt beliebige Knoten, ihre Nachfolger hängen danach am nächsten verbliebenen Vorfahren
+     *
+     * Aktive Nachfolger bleiben erhalten; war einer entfernt, tritt dessen
+     * aktiver Nachfolger an seine Stelle.
+     * @param indices Aufsteigend sortierte Indizes
+     * @return Neue Indizes der umgehängten Knoten mit der Kennung ihres neuen Vorgängers
+     */
+    QList<QPair<int, qint64>> remove(const QList<int>& indices);
+
+    int parent(int index) const;
+    qint64 id(int index) const { return m_nodes[position(index)].id; }
+    qint64 parentId(int index) const;
+    qint64 time(int index) const { return m_nodes[position(index)].time; }
+    qint64 nextId() const { return m_nextId; }
+    bool isLeaf(int index) const { return m_nodes[position(index)].children.isEmpty(); }
+
+    /**
+     * @brief Nachfolger, zu dem Redo springt, oder -1
+     */
+    int redoTarget(int index) const;
+
+    /**
+     * @brief Macht den Weg von der Wurzel bis index zum aktiven Weg
+     */
+    void activatePath(int index);
+
+    /**
+     * @brief Folgt den aktiven Nachfolgern bis zum Ende des Zweigs
+     */
+    int tip(int index) const;
+
+    /**
+     * @brief Liefert die Zweige an der nächsten Verzweigung oberhalb von index
+     *
+     * Zurückgegeben werden die Anfangsknoten aller Geschwisterzweige in
+     * Entstehungsreihenfolge. Gibt es keine Verzweigung, ist die Liste leer.
+     * @param branch Erhält den Anfangsknoten des Zweigs, in dem index liegt
+     */
+    QList<int> branchesAt(int index, int* branch = nullptr) const;
+
+    /**
+     * @brief Setzt Kennung, Vorgänger und Zeitpunkt eines Eintrags
+     */
+    static void storeLinks(QJsonObject& entry, qint64 id, qint64 parentId, qint64 time);
+
+private:
+    struct Node {
+        qint64 id = 0;
+        qint64 time = 0;
+        int parent = -1;        // Position im Vektor, -1 für Wurzel
+        int activeChild = -1;   // Position im Vektor, -1 wenn keiner
+        QVector<int> children;  // Positionen im Vektor, aufsteigend
+    };
+
+    QVector<Node> m_nodes;
+    QHash<qint64, int> m_positions;  // Kennung -> Position im Vektor
+    int m_front;                // Anzahl bereits entfernter Knoten am Anfang
+    qint64 m_nextId;
+    bool m_needsMigration;
+
+    int position(int index) const { return m_front + index; }
+    int indexOf(int pos) const { return pos >= m_front ? pos - m_front : -1; }
+    void compact();
+};
+
+#endif
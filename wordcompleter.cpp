@@ -0,0 +1,153 @@
+#include "wordcompleter.h"
+
+namespace {
+
+const int MAX_TYPED_CHARS = 64;     // Größere Einfügungen gelten nicht als Tippen
+
+bool isWordChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_';
+}
+
+bool isJoiner(QChar c)
+{
+    return c == '-' || c == '.' || c == ':';
+}
+
+/**
+ * @brief Wörter eines Absatzes, entfernt sie beim Löschen des Absatzes wieder aus dem Wortschatz
+ */
+class BlockWords : public QTextBlockUserData
+{
+public:
+    explicit BlockWords(std::shared_ptr<WordTrie> vocabulary)
+        : vocabulary(std::move(vocabulary))
+    {
+    }
+
+    ~BlockWords() override
+    {
+        for (const QString& word : words) vocabulary->remove(word);
+    }
+
+    std::shared_ptr<WordTrie> vocabulary;   // Geteilt, falls der Completer vor dem Dokument verschwindet
+    QStringList words;
+};
+
+} // namespace
+
+WordCompleter::WordCompleter(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_vocabulary(std::make_shared<WordTrie>()),
+      m_enabled(false), m_typedEnd(-1)
+{
+    connect(m_document, &QTextDocument::contentsChange, this, &WordCompleter::onContentsChange);
+}
+
+void WordCompleter::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled) return;
+    m_enabled = enabled;
+    m_typedEnd = -1;
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        if (enabled) {
+            indexBlock(block);
+        } else {
+            block.setUserData(nullptr);
+        }
+    }
+    if (!enabled) m_historyVocabulary.reset();
+}
+
+void WordCompleter::forEachWord(QStringView text, const std::function<void(QStringView word)>& fn)
+{
+    qsizetype i = 0;
+    while (i < text.size()) {
+        if (!isWordChar(text[i])) {
+            ++i;
+            continue;
+        }
+        const qsizetype start = i;
+        while (i < text.size() && (isWordChar(text[i])
+                                   || (isJoiner(text[i]) && i + 1 < text.size() && isWordChar(text[i + 1])))) {
+            ++i;
+        }
+        const qsizetype length = i - start;
+        if (length >= MIN_WORD && length <= MAX_WORD) fn(text.mid(start, length));
+    }
+}
+
+/**
+ * @brief Zerlegt einen Absatz neu und gleicht den Wortschatz nur um die geänderten Wörter ab
+ */
+void WordCompleter::indexBlock(QTextBlock block)
+{
+    QStringList words;
+    const QString text = block.text();
+    if (text.size() <= MAX_BLOCK_CHARS) {
+        forEachWord(text, [&words](QStringView word) { words.append(word.toString()); });
+    }
+
+    BlockWords* data = static_cast<BlockWords*>(block.userData());
+    if (!data) {
+        if (words.isEmpty()) return;
+        data = new BlockWords(m_vocabulary);
+        block.setUserData(data);
+    }
+
+    // Beim Tippen ändert sich meist nur ein Wort: gemeinsamen Anfang und Ende überspringen
+    const QStringList& old = data->words;
+    qsizetype prefix = 0;
+    while (prefix < old.size() && prefix < words.size() && old[prefix] == words[prefix]) ++prefix;
+    qsizetype suffix = 0;
+    while (suffix < old.size() - prefix && suffix < words.size() - prefix
+           && old[old.size() - 1 - suffix] == words[words.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    for (qsizetype i = prefix; i < words.size() - suffix; ++i) m_vocabulary->insert(words[i]);
+    for (qsizetype i = prefix; i < old.size() - suffix; ++i) m_vocabulary->remove(old[i]);
+    data->words = words;
+}
+
+void WordCompleter::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    if (!m_enabled) return;
+    m_typedEnd = charsAdded > 0 && charsAdded <= MAX_TYPED_CHARS ? position + charsAdded : -1;
+
+    // Alle Absätze, die die Einfügung berührt; gelöschte sind bereits samt Wörtern entfernt
+    QTextBlock block = m_document->findBlock(position);
+    const QTextBlock last = m_document->findBlock(position + charsAdded);
+    while (block.isValid()) {
+        indexBlock(block);
+        if (block == last) break;
+        block = block.next();
+    }
+}
+
+QString WordCompleter::suggestion(int position) const
+{
+    if (!m_enabled || position != m_typedEnd) return QString();
+
+    const QTextBlock block = m_document->findBlock(position);
+    const QString text = block.text();
+    const qsizetype offset = position - block.position();
+    if (offset <= 0 || offset > text.size() || !QStringView(text).mid(offset).trimmed().isEmpty()) return QString();
+
+    // Wortanfang suchen, ein Bindezeichen am Ende gehört zum Präfix ("db-" → "db-01")
+    qsizetype start = offset;
+    while (start > 0 && (isWordChar(text[start - 1])
+                         || (isJoiner(text[start - 1]) && start >= 2 && isWordChar(text[start - 2])))) {
+        --start;
+    }
+    if (offset - start < MIN_PREFIX || !isWordChar(text[start])) return QString();
+
+    const QStringView prefix = QStringView(text).mid(start, offset - start);
+    QStringList found = m_vocabulary->complete(prefix, 1);
+    if (found.isEmpty() && m_historyVocabulary) found = m_historyVocabulary->complete(prefix, 1);
+    return found.isEmpty() ? QString() : found.first().mid(prefix.size());
+}
+
+void WordCompleter::setHistoryVocabulary(std::shared_ptr<const WordTrie> vocabulary)
+{
+    m_historyVocabulary = m_enabled ? std::move(vocabulary) : nullptr;
+}
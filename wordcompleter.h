@@ -0,0 +1,75 @@
+#ifndef WORDCOMPLETER_H
+#define WORDCOMPLETER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringView>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <functional>
+#include <memory>
+#include "wordtrie.h"
+
+/**
+ * @brief Schlägt Wörter aus dem Wortschatz der Notiz zur Vervollständigung vor
+ *
+ * Der Wortschatz wird über QTextDocument::contentsChange nachgeführt: nur
+ * die geänderten Absätze werden neu zerlegt. Jeder Absatz merkt sich seine
+ * Wörter in den Benutzerdaten des QTextBlock; wird der Absatz gelöscht,
+ * nimmt Qt die Benutzerdaten mit und deren Destruktor entfernt die Wörter
+ * wieder. toPlainText() wird dafür nie aufgerufen.
+ *
+ * Wörter bestehen aus Buchstaben, Ziffern und '_', im Inneren auch aus '-',
+ * '.' und ':', damit Hostnamen und Ticketnummern als Ganzes gelten.
+ * Optional ergänzt ein zweiter Wortschatz aus älteren Versionen die
+ * Vorschläge, wenn die Notiz selbst keinen passenden hat.
+ */
+class WordCompleter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int MIN_WORD = 3;              // Kürzere Wörter werden nicht erfasst
+    static const int MAX_WORD = 64;
+    static const int MIN_PREFIX = 2;            // Vorschläge erst ab so vielen Zeichen
+    static const int MAX_BLOCK_CHARS = 64 * 1024;  // Längere Absätze werden nicht erfasst
+
+    explicit WordCompleter(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Erfasst beim Einschalten alle Absätze, beim Ausschalten wird der Wortschatz verworfen
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Ergänzung für das Wort vor position, leer wenn es keine gibt
+     *
+     * Vorgeschlagen wird nur direkt nach dem Tippen und am Absatzende, damit
+     * der Vorschlag keinen folgenden Text verdeckt.
+     * @return Nur der fehlende Rest des Worts
+     */
+    QString suggestion(int position) const;
+
+    /**
+     * @brief Wortschatz aus älteren Versionen, nullptr verwirft ihn
+     */
+    void setHistoryVocabulary(std::shared_ptr<const WordTrie> vocabulary);
+
+    /**
+     * @brief Ruft fn für jedes Wort in text auf, wie es in den Wortschatz aufgenommen wird
+     */
+    static void forEachWord(QStringView text, const std::function<void(QStringView word)>& fn);
+
+private:
+    QTextDocument* m_document;
+    std::shared_ptr<WordTrie> m_vocabulary;
+    std::shared_ptr<const WordTrie> m_historyVocabulary;
+    bool m_enabled;
+    int m_typedEnd;             // Ende der letzten getippten Einfügung, sonst -1
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void indexBlock(QTextBlock block);
+};
+
+#endif
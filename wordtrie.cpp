@@ -0,0 +1,164 @@
+#include "wordtrie.h"
+#include <algorithm>
+#include <queue>
+
+WordTrie::WordTrie()
+    : m_nodes(1), m_freeList(-1), m_words(0)
+{
+}
+
+void WordTrie::clear()
+{
+    m_nodes = QVector<Node>(1);
+    m_freeList = -1;
+    m_words = 0;
+}
+
+int WordTrie::child(int node, char16_t ch) const
+{
+    for (int c = m_nodes[node].firstChild; c >= 0; c = m_nodes[c].next) {
+        if (m_nodes[c].ch == ch) return c;
+    }
+    return -1;
+}
+
+int WordTrie::addChild(int node, char16_t ch)
+{
+    int c = m_freeList;
+    if (c >= 0) {
+        m_freeList = m_nodes[c].next;
+    } else {
+        c = m_nodes.size();
+        m_nodes.append(Node());
+    }
+    m_nodes[c].ch = ch;
+    m_nodes[c].next = m_nodes[node].firstChild;
+    m_nodes[node].firstChild = c;
+    return c;
+}
+
+/**
+ * @brief Gibt einen ausgehängten Teilbaum zur Wiederverwendung frei
+ */
+void WordTrie::release(int node)
+{
+    QVector<int> stack{node};
+    while (!stack.isEmpty()) {
+        const int n = stack.takeLast();
+        for (int c = m_nodes[n].firstChild; c >= 0; c = m_nodes[c].next) stack.append(c);
+        m_nodes[n] = Node();
+        m_nodes[n].next = m_freeList;
+        m_freeList = n;
+    }
+}
+
+int WordTrie::find(QStringView word) const
+{
+    int node = 0;
+    for (QChar c : word) {
+        node = child(node, c.unicode());
+        if (node < 0) return -1;
+    }
+    return node;
+}
+
+void WordTrie::insert(QStringView word)
+{
+    if (word.isEmpty()) return;
+    int node = 0;
+    m_nodes[0].total++;
+    for (QChar c : word) {
+        int next = child(node, c.unicode());
+        if (next < 0) next = addChild(node, c.unicode());
+        node = next;
+        m_nodes[node].total++;
+    }
+    if (m_nodes[node].count++ == 0) ++m_words;
+}
+
+void WordTrie::remove(QStringView word)
+{
+    const int end = word.isEmpty() ? -1 : find(word);
+    if (end < 0 || m_nodes[end].count == 0) return;
+    if (--m_nodes[end].count == 0) --m_words;
+
+    // Häufigkeiten entlang des Pfads verringern, leere Teilbäume aushängen
+    int node = 0;
+    m_nodes[0].total--;
+    for (QChar c : word) {
+        int previous = -1;
+        int next = m_nodes[node].firstChild;
+        while (m_nodes[next].ch != c.unicode()) {
+            previous = next;
+            next = m_nodes[next].next;
+        }
+        if (--m_nodes[next].total == 0) {
+            if (previous < 0) {
+                m_nodes[node].firstChild = m_nodes[next].next;
+            } else {
+                m_nodes[previous].next = m_nodes[next].next;
+            }
+            release(next);
+            return;
+        }
+        node = next;
+    }
+}
+
+int WordTrie::count(QStringView word) const
+{
+    const int node = word.isEmpty() ? -1 : find(word);
+    return node < 0 ? 0 : m_nodes[node].count;
+}
+
+QStringList WordTrie::complete(QStringView prefix, int limit) const
+{
+    const int start = prefix.isEmpty() ? -1 : find(prefix);
+    if (start < 0 || limit <= 0) return {};
+
+    struct Pending {
+        int total;
+        int node;
+        QString word;
+        bool operator<(const Pending& other) const { return total < other.total; }
+    };
+    struct Candidate {
+        int count;
+        QString word;
+    };
+    const auto better = [](const Candidate& a, const Candidate& b) {
+        if (a.count != b.count) return a.count > b.count;
+        if (a.word.size() != b.word.size()) return a.word.size() < b.word.size();
+        return a.word < b.word;
+    };
+
+    // Teilbäume mit der höchsten Häufigkeit zuerst
+    std::priority_queue<Pending> queue;
+    const QString base = prefix.toString();
+    for (int c = m_nodes[start].firstChild; c >= 0; c = m_nodes[c].next) {
+        queue.push({m_nodes[c].total, c, base + QChar(m_nodes[c].ch)});
+    }
+
+    QVector<Candidate> best;    // Die besten limit Treffer, sortiert
+    int visited = 0;
+    while (!queue.empty() && visited++ < MAX_VISITED) {
+        const Pending pending = queue.top();
+        queue.pop();
+        // Kein verbleibender Teilbaum kann den schwächsten Treffer noch übertreffen
+        if (best.size() >= limit && pending.total < best.last().count) break;
+
+        const Node& node = m_nodes[pending.node];
+        if (node.count > 0) {
+            const Candidate candidate{node.count, pending.word};
+            best.insert(std::upper_bound(best.begin(), best.end(), candidate, better), candidate);
+            if (best.size() > limit) best.removeLast();
+        }
+        for (int c = node.firstChild; c >= 0; c = m_nodes[c].next) {
+            queue.push({m_nodes[c].total, c, pending.word + QChar(m_nodes[c].ch)});
+        }
+    }
+
+    QStringList result;
+    for (const Candidate& candidate : best) result.append(candidate.word);
+    return result;
+}
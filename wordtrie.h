@@ -0,0 +1,70 @@
+#ifndef WORDTRIE_H
+#define WORDTRIE_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+/**
+ * @brief Wortschatz mit Häufigkeiten für die Wortvervollständigung
+ *
+ * Die Knoten liegen in einem einzigen Vektor, Kinder als einfach verkettete
+ * Geschwisterliste (erstes Kind, nächster Bruder), je Knoten 20 Bytes.
+ * Jeder Knoten kennt die Summe der Häufigkeiten darunter; fällt sie beim
+ * Entfernen auf 0, wird der Teilbaum ausgehängt und seine Knoten werden
+ * wiederverwendet. Einfügen und Entfernen kosten nur die Wortlänge.
+ *
+ * complete() besucht höchstens MAX_VISITED Knoten und bevorzugt dabei
+ * Teilbäume mit hoher Häufigkeit, die Antwortzeit hängt daher nicht von der
+ * Größe des Wortschatzes ab.
+ */
+class WordTrie
+{
+public:
+    static const int MAX_VISITED = 4096;
+
+    WordTrie();
+
+    void insert(QStringView word);
+
+    /**
+     * @brief Verringert die Häufigkeit eines Worts, unbekannte Wörter werden ignoriert
+     */
+    void remove(QStringView word);
+
+    void clear();
+
+    /**
+     * @brief Anzahl verschiedener Wörter
+     */
+    int size() const { return m_words; }
+
+    int count(QStringView word) const;
+
+    /**
+     * @brief Häufigste Wörter, die mit prefix beginnen und länger sind
+     * @return Absteigend nach Häufigkeit, bei Gleichstand kürzere zuerst
+     */
+    QStringList complete(QStringView prefix, int limit) const;
+
+private:
+    struct Node {
+        char16_t ch = 0;
+        int firstChild = -1;
+        int next = -1;          // Nächster Bruder oder nächster freier Knoten
+        int count = 0;          // Häufigkeit des Worts, das hier endet
+        int total = 0;          // Summe aller Häufigkeiten im Teilbaum
+    };
+
+    QVector<Node> m_nodes;      // Knoten 0 ist die Wurzel
+    int m_freeList;
+    int m_words;
+
+    int child(int node, char16_t ch) const;
+    int addChild(int node, char16_t ch);
+    void release(int node);
+    int find(QStringView word) const;
+};
+
+#endif